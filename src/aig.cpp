@@ -0,0 +1,146 @@
+#include "aig.hpp"
+
+namespace {
+const uint32_t NO_AIG_NODE = 0xffffffff;
+}
+
+AIG::AIG() : left(1, AIG_FALSE), right(1, AIG_FALSE), symbol(1, 0) {}
+
+AigLit AIG::make_input(uint32_t sym) {
+    if(sym >= input_of.size()){
+        input_of.resize(sym + 1, AIG_FALSE);
+    }
+    if(input_of[sym] == AIG_FALSE){
+        input_of[sym] = size() << 1;
+        left.push_back(AIG_FALSE);
+        right.push_back(AIG_FALSE);
+        symbol.push_back(sym);
+    }
+    return input_of[sym];
+}
+
+AigLit AIG::rewrite(AigLit a, AigLit b) {
+    AigLit c = left[aig_node(b)];
+    AigLit d = right[aig_node(b)];
+    if(!aig_complemented(b)){
+        if(a == aig_not(c) || a == aig_not(d)){
+            return AIG_FALSE;   // contradiction: a AND NOT a AND d
+        }
+        if(a == c || a == d){
+            return b;           // idempotence: a AND a AND d
+        }
+        if(is_and(aig_node(a)) && !aig_complemented(a)){
+            // contradiction between the fanins of two AND nodes
+            AigLit e = left[aig_node(a)];
+            AigLit f = right[aig_node(a)];
+            if(e == aig_not(c) || e == aig_not(d) || f == aig_not(c) || f == aig_not(d)){
+                return AIG_FALSE;
+            }
+        }
+        return NO_LIT;
+    }
+    if(a == aig_not(c) || a == aig_not(d)){
+        return a;               // subsumption: NOT c implies NOT (c AND d)
+    }
+    if(a == c){
+        return make_and(a, aig_not(d));   // substitution: c AND NOT (c AND d) = c AND NOT d
+    }
+    if(a == d){
+        return make_and(a, aig_not(c));
+    }
+    return NO_LIT;
+}
+
+AigLit AIG::make_and(AigLit a, AigLit b) {
+    if(a > b){
+        std::swap(a, b);
+    }
+    // the constant node comes first, so a constant operand is always a
+    if(a == AIG_FALSE || a == aig_not(b)){
+        return AIG_FALSE;
+    }
+    if(a == AIG_TRUE || a == b){
+        return b;
+    }
+    AigLit simpler = is_and(aig_node(b)) ? rewrite(a, b) : NO_LIT;
+    if(simpler == NO_LIT && is_and(aig_node(a))){
+        simpler = rewrite(b, a);
+    }
+    if(simpler != NO_LIT){
+        rewrites++;
+        return simpler;
+    }
+
+    // keep the load factor at most 1/2 so probe sequences stay short
+    if(2 * (and_count + 1) > table.size()){
+        grow();
+    }
+    uint64_t hash = mix64(((uint64_t)a << 32) | b);
+    size_t mask = table.size() - 1;
+    size_t slot = hash & mask;
+    for(; table[slot].id != NO_AIG_NODE; slot = (slot + 1) & mask){
+        uint32_t node = table[slot].id;
+        if(table[slot].hash == hash && left[node] == a && right[node] == b){
+            return node << 1;
+        }
+    }
+    uint32_t id = size();
+    left.push_back(a);
+    right.push_back(b);
+    symbol.push_back(0);
+    table[slot] = {hash, id};
+    and_count++;
+    return id << 1;
+}
+
+AigLit AIG::make_atleast(uint32_t bound, const AigLit* operands, uint32_t count) {
+    if(bound == 0){
+        return AIG_TRUE;
+    }
+    // at[j] is "at least j + 1 of the operands so far"; the constant rules of
+    // make_and() keep the counts that cannot be reached yet from making nodes
+    std::vector<AigLit> at(bound, AIG_FALSE);
+    for(uint32_t i = 0; i < count; i++){
+        for(uint32_t j = bound - 1; j > 0; j--){
+            at[j] = make_or(at[j], make_and(at[j - 1], operands[i]));
+        }
+        at[0] = make_or(at[0], operands[i]);
+    }
+    return at[bound - 1];
+}
+
+void AIG::grow() {
+    std::vector<Slot> old;
+    old.swap(table);
+    table.assign(old.empty() ? 64 : 2 * old.size(), {0, NO_AIG_NODE});
+    size_t mask = table.size() - 1;
+    for(auto& entry: old){
+        if(entry.id == NO_AIG_NODE){
+            continue;
+        }
+        size_t slot = entry.hash & mask;
+        while(table[slot].id != NO_AIG_NODE){
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = entry;
+    }
+}
+
+AigLit build_aig(Formula* f, AIG& aig) {
+    return fold<AigLit>(f, [&](const Formula* node, const AigLit* operands) -> AigLit {
+        switch(node->op){
+            case FormulaOp::VAR: return aig.make_input(static_cast<const Variable*>(node)->id);
+            case FormulaOp::NOT: return aig_not(operands[0]);
+            case FormulaOp::AND: return aig.make_and(operands[0], operands[1]);
+            case FormulaOp::OR: return aig.make_or(operands[0], operands[1]);
+            case FormulaOp::IMPLIES: return aig.make_implies(operands[0], operands[1]);
+            case FormulaOp::EQ: return aig.make_eq(operands[0], operands[1]);
+            case FormulaOp::CONST: return static_cast<const Constant*>(node)->value ? AIG_TRUE : AIG_FALSE;
+            case FormulaOp::XOR: return aig.make_xor(operands[0], operands[1]);
+            case FormulaOp::ITE: return aig.make_ite(operands[0], operands[1], operands[2]);
+            case FormulaOp::ATLEAST:
+                return aig.make_atleast(static_cast<const AtLeast*>(node)->bound, operands, node->arity());
+        }
+        return AIG_FALSE;
+    });
+}
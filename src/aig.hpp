@@ -0,0 +1,67 @@
+#ifndef __AIG__
+#define __AIG__
+#include "dagformula.hpp"
+
+// An edge of an And-Inverter Graph: the id of the node it points to shifted left
+// by one, with the lowest bit set when the edge is complemented. Negation is
+// therefore free and never creates a node. Node 0 is the constant FALSE.
+using AigLit = uint32_t;
+const AigLit AIG_FALSE = 0;
+const AigLit AIG_TRUE = 1;
+const AigLit NO_LIT = 0xffffffff;
+
+inline AigLit aig_not(AigLit lit) { return lit ^ 1; }
+inline uint32_t aig_node(AigLit lit) { return lit >> 1; }
+inline bool aig_complemented(AigLit lit) { return lit & 1; }
+
+// And-Inverter Graph: every gate is a two-input AND over possibly complemented
+// edges, and OR, IMPLIES, EQ, XOR, ITE and NOT are lowered onto it by De Morgan,
+// at-least-k onto a sequential counter.
+// Fanins are created before the nodes that read them, so node ids are a
+// topological order. AND nodes are hash-consed on their ordered pair of edges, and
+// make_and() first tries the constant, idempotence and contradiction rules on
+// its inputs and on the fanins of input nodes one level down, so that x, NOT x
+// and NOT NOT x share one node and x AND NOT x is FALSE wherever it appears.
+struct AIG {
+    std::vector<AigLit> left;       // fanins of an AND node, left < right
+    std::vector<AigLit> right;
+    std::vector<uint32_t> symbol;   // symbol_table id of an input node, unused otherwise
+    size_t and_count = 0;
+    size_t rewrites = 0;            // make_and() calls answered by a rule without a new node
+
+    AIG();
+
+    size_t size() const { return left.size(); }
+    bool is_and(uint32_t node) const { return left[node] != right[node]; }
+    bool is_input(uint32_t node) const { return node != 0 && left[node] == right[node]; }
+
+    // return the edge of the given input or gate, creating it if needed
+    AigLit make_input(uint32_t sym);
+    AigLit make_and(AigLit a, AigLit b);
+    AigLit make_or(AigLit a, AigLit b) { return aig_not(make_and(aig_not(a), aig_not(b))); }
+    AigLit make_implies(AigLit a, AigLit b) { return make_or(aig_not(a), b); }
+    AigLit make_eq(AigLit a, AigLit b) {
+        return make_and(aig_not(make_and(a, aig_not(b))), aig_not(make_and(aig_not(a), b)));
+    }
+    AigLit make_xor(AigLit a, AigLit b) { return aig_not(make_eq(a, b)); }
+    AigLit make_ite(AigLit c, AigLit t, AigLit e) { return make_or(make_and(c, t), make_and(aig_not(c), e)); }
+    AigLit make_atleast(uint32_t bound, const AigLit* operands, uint32_t count);
+
+private:
+    struct Slot {
+        uint64_t hash;
+        uint32_t id;
+    };
+    std::vector<Slot> table;            // AND nodes, size is a power of two
+    std::vector<AigLit> input_of;       // edge of each symbol's input, AIG_FALSE if none yet
+
+    // the one-level rules for a AND b where b points to an AND node, or
+    // NO_LIT when none applies
+    AigLit rewrite(AigLit a, AigLit b);
+    void grow();
+};
+
+// add the nodes of formula f to aig and return the edge of f
+AigLit build_aig(Formula* f, AIG& aig);
+
+#endif
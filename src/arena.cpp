@@ -0,0 +1,77 @@
+#include "arena.hpp"
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+char* align_up(char* p, size_t align) {
+    auto address = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char*>((address + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+char* chunk_data(void* chunk, size_t header) {
+    return static_cast<char*>(chunk) + header;
+}
+}
+
+Arena::Arena(size_t chunk_size) : chunk_size(chunk_size) {}
+
+Arena::~Arena() {
+    reset();
+    std::free(chunks);
+}
+
+void Arena::add_chunk(size_t min_size) {
+    size_t size = min_size > chunk_size ? min_size : chunk_size;
+    auto chunk = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + size));
+    if(chunk == nullptr){
+        throw std::bad_alloc();
+    }
+    chunk->next = chunks;
+    chunk->size = size;
+    chunks = chunk;
+    cursor = chunk_data(chunk, sizeof(Chunk));
+    limit = cursor + size;
+    counters.bytes_reserved += size;
+    counters.chunks++;
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    if(cursor == nullptr || align_up(cursor, align) + size > limit){
+        add_chunk(size + align);
+    }
+    char* p = align_up(cursor, align);
+    cursor = p + size;
+    counters.bytes_used += size;
+    return p;
+}
+
+void Arena::add_finalizer(void* object, void (*destroy)(void*)) {
+    auto finalizer = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+    finalizer->destroy = destroy;
+    finalizer->object = object;
+    finalizer->next = finalizers;
+    finalizers = finalizer;
+}
+
+void Arena::reset() {
+    // destroy in reverse order of creation
+    for(auto f = finalizers; f; f = f->next){
+        f->destroy(f->object);
+    }
+    finalizers = nullptr;
+
+    // keep only the oldest chunk
+    while(chunks && chunks->next){
+        auto next = chunks->next;
+        counters.bytes_reserved -= chunks->size;
+        counters.chunks--;
+        std::free(chunks);
+        chunks = next;
+    }
+    cursor = chunks ? chunk_data(chunks, sizeof(Chunk)) : nullptr;
+    limit = chunks ? cursor + chunks->size : nullptr;
+
+    counters.objects = 0;
+    counters.bytes_used = 0;
+    counters.resets++;
+}
@@ -0,0 +1,66 @@
+#ifndef __ARENA__
+#define __ARENA__
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+struct ArenaStats {
+    size_t objects = 0;         // objects made since the last reset
+    size_t bytes_used = 0;      // bytes handed out since the last reset
+    size_t bytes_reserved = 0;  // bytes currently held in chunks
+    size_t chunks = 0;          // chunks currently held
+    size_t resets = 0;
+};
+
+// Bump allocator for objects that live and die together, such as the nodes of
+// one formula. Objects are carved out of large chunks and are never freed one by
+// one; reset() releases all of them at once and keeps the first chunk for reuse,
+// so a loop that builds and drops a formula per query runs in steady-state memory.
+// Only objects that are not trivially destructible are destroyed by reset().
+class Arena {
+public:
+    explicit Arena(size_t chunk_size = 64 * 1024);
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template<typename T, typename... Args>
+    T* make(Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if(!std::is_trivially_destructible<T>::value){
+            add_finalizer(object, [](void* p){ static_cast<T*>(p)->~T(); });
+        }
+        counters.objects++;
+        return object;
+    }
+
+    // destroy and release every object made so far
+    void reset();
+    const ArenaStats& stats() const { return counters; }
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;    // usable bytes after the header
+    };
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+
+    size_t chunk_size;
+    Chunk* chunks = nullptr;      // most recent chunk first
+    char* cursor = nullptr;       // next free byte in the current chunk
+    char* limit = nullptr;        // end of the current chunk
+    Finalizer* finalizers = nullptr;
+    ArenaStats counters;
+
+    void add_chunk(size_t min_size);
+    void add_finalizer(void* object, void (*destroy)(void*));
+};
+
+#endif
@@ -0,0 +1,499 @@
+#include "benchmarks.hpp"
+#include "formula.hpp"
+#include "dagformula.hpp"
+#include "dagsolver.hpp"
+#include "gates.hpp"
+#include "aig.hpp"
+#include "normalize.hpp"
+#include "cardinality.hpp"
+#include "jit.hpp"
+#include "arena.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+Arena arena;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a conjunction of random 3-literal clauses over x0 .. x(vars-1)
+Formula* random_3cnf(int vars, int clauses, uint64_t seed) {
+    std::vector<Formula*> literals;
+    for(int i = 0; i < vars; i++){
+        auto var = arena.make<Variable>("x" + std::to_string(i));
+        literals.push_back(var);
+        literals.push_back(arena.make<Not>(var));
+    }
+    Formula* cnf = nullptr;
+    for(int c = 0; c < clauses; c++){
+        Formula* clause = nullptr;
+        for(int k = 0; k < 3; k++){
+            seed = mix64(seed + 0x9e3779b97f4a7c15ULL);
+            auto literal = literals[seed % literals.size()];
+            clause = clause ? arena.make<Or>(clause, literal) : literal;
+        }
+        cnf = cnf ? arena.make<And>(cnf, clause) : clause;
+    }
+    return cnf;
+}
+
+// a conjunction of random constraints of depth 3 over x0 .. x(vars-1), built
+// from every connective
+Formula* random_constraints(int vars, int constraints, uint64_t seed) {
+    std::vector<Variable*> inputs;
+    for(int i = 0; i < vars; i++){
+        inputs.push_back(arena.make<Variable>("x" + std::to_string(i)));
+    }
+    auto next = [&](uint64_t bound){
+        seed = mix64(seed + 0x9e3779b97f4a7c15ULL);
+        return seed % bound;
+    };
+    std::vector<Formula*> stack;
+    Formula* conjunction = nullptr;
+    for(int c = 0; c < constraints; c++){
+        // the leaves of a complete binary tree of depth 3, then its inner nodes
+        for(int k = 0; k < 8; k++){
+            Formula* leaf = inputs[next(vars)];
+            stack.push_back(next(2) ? arena.make<Not>(leaf) : leaf);
+        }
+        while(stack.size() > 1){
+            auto right = stack.back();
+            stack.pop_back();
+            auto left = stack.back();
+            stack.pop_back();
+            Formula* f = nullptr;
+            switch(next(5)){
+                case 0: f = arena.make<And>(left, right); break;
+                case 1: f = arena.make<Or>(left, right); break;
+                case 2: f = arena.make<Implies>(left, right); break;
+                case 3: f = arena.make<Eq>(left, right); break;
+                default: f = arena.make<Not>(arena.make<Or>(left, right)); break;
+            }
+            stack.insert(stack.begin(), f);
+        }
+        conjunction = conjunction ? arena.make<And>(conjunction, stack[0]) : stack[0];
+        stack.clear();
+    }
+    return conjunction;
+}
+
+// random_3cnf() with every fourth literal a constant, TRUE seven times out of
+// eight, either as a Constant node or as a placeholder variable fixed by a
+// unit conjunct
+Formula* constant_3cnf(int vars, int clauses, uint64_t seed, bool placeholders) {
+    std::vector<Formula*> literals;
+    for(int i = 0; i < vars; i++){
+        auto var = arena.make<Variable>("x" + std::to_string(i));
+        literals.push_back(var);
+        literals.push_back(arena.make<Not>(var));
+    }
+    Formula* cnf = nullptr;
+    Formula* units = nullptr;
+    int placeholder_count = 0;
+    for(int c = 0; c < clauses; c++){
+        Formula* clause = nullptr;
+        for(int k = 0; k < 3; k++){
+            seed = mix64(seed + 0x9e3779b97f4a7c15ULL);
+            Formula* literal = literals[seed % literals.size()];
+            if((seed >> 32) % 4 == 0){
+                bool value = (seed >> 40) % 8 != 0;
+                if(placeholders){
+                    auto var = arena.make<Variable>("c" + std::to_string(placeholder_count++));
+                    Formula* unit = value ? (Formula*)var : arena.make<Not>(var);
+                    units = units ? arena.make<And>(units, unit) : unit;
+                    literal = var;
+                }
+                else{
+                    literal = arena.make<Constant>(value);
+                }
+            }
+            clause = clause ? arena.make<Or>(clause, literal) : literal;
+        }
+        cnf = cnf ? arena.make<And>(cnf, clause) : clause;
+    }
+    return units ? arena.make<And>(cnf, units) : cnf;
+}
+
+// Evaluate the same random input words with the interpreter and the JIT.
+void benchmark_jit() {
+    std::cout << "gate list evaluation, 64 valuations per run:" << std::endl;
+    for(int vars: {50, 500, 5000}){
+        auto gates = compile_gates(random_3cnf(vars, 4 * vars, vars));
+        GateEvaluator interpreter(gates);
+        JitEvaluator jit(gates);
+        int runs = 20000000 / gates.gates.size();
+
+        uint64_t seed = 1;
+        uint64_t interpreted_sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(int r = 0; r < runs; r++){
+            for(size_t i = 0; i < gates.inputs.size(); i++){
+                interpreter.slot[i] = mix64(seed++);
+            }
+            interpreted_sum += interpreter.run();
+        }
+        double interpreted_secs = seconds_since(start);
+
+        seed = 1;
+        uint64_t native_sum = 0;
+        start = std::chrono::steady_clock::now();
+        for(int r = 0; r < runs; r++){
+            for(size_t i = 0; i < gates.inputs.size(); i++){
+                jit.slot[i] = mix64(seed++);
+            }
+            native_sum += jit.run();
+        }
+        double native_secs = seconds_since(start);
+
+        double gate_runs = double(runs) * gates.gates.size();
+        std::cout << "- " << gates.gates.size() << " gates, " << runs << " runs: interpreter "
+                  << std::fixed << std::setprecision(3) << interpreted_secs * 1e9 / gate_runs << " ns/gate, "
+                  << (jit.native() ? "jit " : "jit (interpreter fallback) ")
+                  << native_secs * 1e9 / gate_runs << " ns/gate"
+                  << (interpreted_sum == native_sum ? "" : " MISMATCH") << std::endl;
+    }
+    arena.reset();
+}
+
+// Formula nodes classified and added to a DAG per second by build_dag.
+void benchmark_build() {
+    std::cout << "DAG construction:" << std::endl;
+    for(int vars: {1000, 100000}){
+        auto f = random_3cnf(vars, 4 * vars, vars);
+        size_t formula_nodes = 0;
+        walk(f, [&](const Formula*){ formula_nodes++; }, [](const Formula*, size_t){}, [](const Formula*){});
+
+        DAG dag;
+        double best = 0;
+        for(int r = 0; r < 5; r++){
+            dag.clear();
+            auto start = std::chrono::steady_clock::now();
+            build_dag(f, dag);
+            double secs = seconds_since(start);
+            best = r == 0 || secs < best ? secs : best;
+        }
+        std::cout << "- " << formula_nodes << " formula nodes -> " << dag.size() << " DAG nodes in "
+                  << std::fixed << std::setprecision(4) << best << " s, "
+                  << std::setprecision(1) << formula_nodes / best / 1e6 << " M nodes/s" << std::endl;
+    }
+    arena.reset();
+}
+
+// Generated constants as placeholder variables against folded Constant nodes.
+void benchmark_constants() {
+    std::cout << "constants in a random 3-CNF:" << std::endl;
+    for(bool placeholders: {true, false}){
+        auto f = constant_3cnf(300, 900, 7, placeholders);
+        DAG dag;
+        auto start = std::chrono::steady_clock::now();
+        auto root = build_dag(f, dag);
+        double build_secs = seconds_since(start);
+        DAGSolver solver(dag, root);
+        start = std::chrono::steady_clock::now();
+        bool sat = solver.solve();
+        double solve_secs = seconds_since(start);
+        std::cout << "- " << (placeholders ? "placeholder variables: " : "constants: ") << dag.size() << " DAG nodes ("
+                  << dag.folded_gates << " folded) in " << std::fixed << std::setprecision(4) << build_secs << " s, "
+                  << (sat ? "SAT" : "UNSAT") << " after " << solver.decisions << " decisions in " << solve_secs << " s" << std::endl;
+    }
+    arena.reset();
+}
+
+// Nodes of the DAG and of the And-Inverter Graph of the same formulas.
+void benchmark_aig() {
+    std::cout << "DAG against AIG:" << std::endl;
+    for(int vars: {8, 1000}){
+        auto f = random_constraints(vars, 10000, vars);
+        DAG dag;
+        auto start = std::chrono::steady_clock::now();
+        build_dag(f, dag);
+        double dag_secs = seconds_since(start);
+        AIG aig;
+        start = std::chrono::steady_clock::now();
+        build_aig(f, aig);
+        double aig_secs = seconds_since(start);
+        std::cout << "- " << vars << " variables: " << dag.size() << " DAG nodes in "
+                  << std::fixed << std::setprecision(4) << dag_secs << " s, "
+                  << aig.and_count << " AIG AND nodes (" << aig.rewrites << " rewrites) in " << aig_secs << " s" << std::endl;
+    }
+    arena.reset();
+}
+
+Formula* var(const std::string& name) { return arena.make<Variable>(name); }
+
+Formula* conjunction(const std::vector<Formula*>& parts) {
+    Formula* f = parts[0];
+    for(size_t i = 1; i < parts.size(); i++){
+        f = arena.make<And>(f, parts[i]);
+    }
+    return f;
+}
+
+// (P => Q) and (Q => R) and NOT R, as in the README table
+Formula* implication_chain(const std::string& p, const std::string& q, const std::string& r) {
+    return conjunction({arena.make<Implies>(var(p), var(q)), arena.make<Implies>(var(q), var(r)), arena.make<Not>(var(r))});
+}
+
+// DAG sizes and search times of formulas as written and in sign-normal form,
+// on the repeated-subformula rows of the README and on random constraints.
+void benchmark_normalize() {
+    std::cout << "sign-normal form:" << std::endl;
+    auto triple = [](){ return conjunction({var("x1"), var("x2"), var("x3")}); };
+    auto pq = [](){ return arena.make<And>(var("p"), var("q")); };
+    struct Case {
+        const char* label;
+        Formula* formula;
+    } cases[] = {
+        {"(x1 & x2 & x3) repeated", arena.make<Or>(arena.make<Or>(arena.make<Or>(arena.make<Or>(triple(), triple()), triple()), triple()), triple())},
+        {"((p & q) => r) & ((p & q) => s) & ((p & q) => t) & (p & q)", conjunction({
+            arena.make<Implies>(pq(), var("r")), arena.make<Implies>(pq(), var("s")), arena.make<Implies>(pq(), var("t")), pq()})},
+        {"chains P..R | S..U | P..R", arena.make<Or>(arena.make<Or>(
+            implication_chain("P", "Q", "R"), implication_chain("S", "T", "U")), implication_chain("P", "Q", "R"))},
+        {"(p => q) & ~(~p | q) & ~~(p => q)", conjunction({arena.make<Implies>(var("p"), var("q")),
+            arena.make<Not>(arena.make<Or>(arena.make<Not>(var("p")), var("q"))),
+            arena.make<Not>(arena.make<Not>(arena.make<Implies>(var("p"), var("q"))))})},
+        {"10000 random constraints over 1000 variables", random_constraints(1000, 10000, 1)},
+    };
+    for(auto& c: cases){
+        auto start = std::chrono::steady_clock::now();
+        auto normal = normalize(c.formula, arena);
+        double normalize_secs = seconds_since(start);
+        auto report = compare_normal_form(c.formula, normal);
+
+        double solve_secs[2];
+        Formula* forms[2] = {c.formula, normal};
+        for(int k = 0; k < 2; k++){
+            DAG dag;
+            auto root = build_dag(forms[k], dag);
+            DAGSolver solver(dag, root);
+            start = std::chrono::steady_clock::now();
+            solver.solve();
+            solve_secs[k] = seconds_since(start);
+        }
+        std::cout << "- " << c.label << ": " << report.nodes_before << " -> " << report.nodes_after
+                  << " DAG nodes (" << report.merged() << " merged), normalized in "
+                  << std::fixed << std::setprecision(6) << normalize_secs << " s, search "
+                  << solve_secs[0] << " s -> " << solve_secs[1] << " s" << std::endl;
+    }
+    arena.reset();
+}
+
+// OR(x0 .. x(n-1)) and the implications x(i) => x(i+1): with a final NOT x(n-1)
+// propagation alone refutes it, without it the search decides every variable
+Formula* wide_or(int n, bool refuted) {
+    std::vector<Variable*> vars;
+    for(int i = 0; i < n; i++){
+        vars.push_back(arena.make<Variable>("w" + std::to_string(i)));
+    }
+    Formula* disjunction = vars[0];
+    Formula* chain = nullptr;
+    for(int i = 1; i < n; i++){
+        disjunction = arena.make<Or>(disjunction, vars[i]);
+        Formula* step = arena.make<Implies>(vars[i - 1], vars[i]);
+        chain = chain ? arena.make<And>(chain, step) : step;
+    }
+    Formula* f = arena.make<And>(disjunction, chain);
+    return refuted ? arena.make<And>(f, arena.make<Not>(vars[n - 1])) : f;
+}
+
+// Labels flowing through a gate with 10k children, one event per child.
+void benchmark_wide_gates() {
+    std::cout << "search through a 10000-input OR:" << std::endl;
+    for(bool refuted: {true, false}){
+        DAG dag;
+        auto root = build_dag(wide_or(10000, refuted), dag);
+        DAGSolver solver(dag, root);
+        auto start = std::chrono::steady_clock::now();
+        bool sat = solver.solve();
+        double secs = seconds_since(start);
+        std::cout << "- " << (sat ? "SAT" : "UNSAT") << " after " << solver.decisions << " decisions in "
+                  << std::fixed << std::setprecision(4) << secs << " s" << std::endl;
+    }
+    arena.reset();
+}
+
+// c ? t : e, natively or as (c => t) & (~c => e)
+Formula* mux(Formula* c, Formula* t, Formula* e, bool native) {
+    if(native){
+        return arena.make<Ite>(c, t, e);
+    }
+    return arena.make<And>(arena.make<Implies>(c, t), arena.make<Implies>(arena.make<Not>(c), e));
+}
+
+// A tree of multiplexers selecting data input d<k> where bit i of k is the value
+// of select s<i>; the select of the top level is s<order[0]>, and so on down.
+Formula* mux_tree(const std::vector<int>& order, size_t level, int index, bool native) {
+    if(level == order.size()){
+        return var("d" + std::to_string(index));
+    }
+    int bit = order[level];
+    return mux(var("s" + std::to_string(bit)), mux_tree(order, level + 1, index | 1 << bit, native),
+               mux_tree(order, level + 1, index, native), native);
+}
+
+// Miter of two multiplexer trees that test their selects in opposite orders:
+// the trees agree on every input, so XOR of them is UNSAT. Written with the
+// native operators and with the encodings they replace.
+void benchmark_mux_miter() {
+    std::cout << "miter of two 64-input multiplexer trees:" << std::endl;
+    std::vector<int> order{0, 1, 2, 3, 4, 5};
+    std::vector<int> reversed(order.rbegin(), order.rend());
+    for(bool native: {true, false}){
+        Formula* a = mux_tree(order, 0, 0, native);
+        Formula* b = mux_tree(reversed, 0, 0, native);
+        Formula* miter = native ? (Formula*)arena.make<Xor>(a, b) : arena.make<Not>(arena.make<Eq>(a, b));
+        DAG dag;
+        auto root = build_dag(miter, dag);
+        DAGSolver solver(dag, root);
+        auto start = std::chrono::steady_clock::now();
+        bool sat = solver.solve();
+        double secs = seconds_since(start);
+        std::cout << "- " << (native ? "XOR/ITE: " : "<=> and implications: ") << dag.size() << " DAG nodes, "
+                  << (sat ? "SAT" : "UNSAT") << " after " << solver.decisions << " decisions and "
+                  << solver.conflicts << " conflicts in " << std::fixed << std::setprecision(4) << secs << " s" << std::endl;
+    }
+    arena.reset();
+}
+
+// x0 <=> x1 <=> ... <=> x(n-1) with the variables in the given order
+Formula* equivalence_chain(const std::vector<int>& order) {
+    Formula* f = var("x" + std::to_string(order[0]));
+    for(size_t i = 1; i < order.size(); i++){
+        f = arena.make<Eq>(f, var("x" + std::to_string(order[i])));
+    }
+    return f;
+}
+
+// Two equivalence chains over the same variables in different orders differ
+// nowhere, so NOT (a <=> b) is UNSAT; the labeling rules only see that once
+// every variable is decided, Gaussian elimination before the first decision.
+void benchmark_gauss() {
+    std::cout << "parity miter of two equivalence chains:" << std::endl;
+    for(int n: {10, 14}){
+        std::vector<int> order(n);
+        for(int i = 0; i < n; i++){
+            order[i] = i;
+        }
+        std::vector<int> shuffled(order);
+        for(int i = n - 1; i > 0; i--){
+            std::swap(shuffled[i], shuffled[mix64(i) % (i + 1)]);
+        }
+        Formula* miter = arena.make<Not>(arena.make<Eq>(equivalence_chain(order), equivalence_chain(shuffled)));
+        for(bool gauss: {true, false}){
+            DAG dag;
+            auto root = build_dag(miter, dag);
+            DAGSolver solver(dag, root, gauss);
+            auto start = std::chrono::steady_clock::now();
+            bool sat = solver.solve();
+            double secs = seconds_since(start);
+            std::cout << "- " << n << " variables, " << (gauss ? "Gaussian elimination: " : "labeling rules only: ")
+                      << (sat ? "SAT" : "UNSAT") << " after " << solver.decisions << " decisions and "
+                      << solver.conflicts << " conflicts in " << std::fixed << std::setprecision(4) << secs << " s" << std::endl;
+        }
+    }
+    arena.reset();
+}
+
+// the literal of task i in a schedule
+Formula* task(int i) { return var("t" + std::to_string(i)); }
+
+// at most k of the first n tasks, natively or as NOT (a AND b AND ...) for
+// every k + 1 of them
+Formula* at_most(int k, int n, bool native) {
+    std::vector<Formula*> parts;
+    if(native){
+        for(int i = 0; i < n; i++){
+            parts.push_back(task(i));
+        }
+        return arena.make<Not>(make_at_least(arena, k + 1, parts.data(), parts.size()));
+    }
+    std::vector<int> pick(k + 1);
+    for(int i = 0; i <= k; i++){
+        pick[i] = i;
+    }
+    while(true){
+        std::vector<Formula*> tasks;
+        for(int i: pick){
+            tasks.push_back(task(i));
+        }
+        parts.push_back(arena.make<Not>(conjunction(tasks)));
+        // next combination in lexicographic order
+        int i = k;
+        while(i >= 0 && pick[i] == n - k - 1 + i){
+            i--;
+        }
+        if(i < 0){
+            break;
+        }
+        pick[i]++;
+        for(int j = i + 1; j <= k; j++){
+            pick[j] = pick[j - 1] + 1;
+        }
+    }
+    return conjunction(parts);
+}
+
+// k + 1 disjoint pairs of tasks of which one each must run
+Formula* demands(int k) {
+    std::vector<Formula*> parts;
+    for(int i = 0; i <= k; i++){
+        parts.push_back(arena.make<Or>(task(2 * i), task(2 * i + 1)));
+    }
+    return conjunction(parts);
+}
+
+// At most k of 50 tasks against k + 1 tasks that must run: UNSAT. The encoding
+// by one exclusion per k + 1 tasks grows as 50 choose k + 1, the cardinality
+// node stays one node; and a pairwise at-most-one collapses back into it.
+void benchmark_cardinality() {
+    std::cout << "at most k of 50 tasks:" << std::endl;
+    auto report_solve = [](const char* label, DAG& dag, NodeId root, double build_secs){
+        DAGSolver solver(dag, root);
+        auto start = std::chrono::steady_clock::now();
+        bool sat = solver.solve();
+        double secs = seconds_since(start);
+        std::cout << "- " << label << ": " << dag.size() << " DAG nodes built in " << std::fixed << std::setprecision(6)
+                  << build_secs << " s, " << (sat ? "SAT" : "UNSAT") << " after " << solver.decisions << " decisions and "
+                  << solver.conflicts << " conflicts in " << secs << " s" << std::endl;
+    };
+    for(bool native: {true, false}){
+        Formula* f = arena.make<And>(at_most(2, 50, native), demands(2));
+        DAG dag;
+        auto start = std::chrono::steady_clock::now();
+        auto root = build_dag(f, dag);
+        report_solve(native ? "at most 2, ATLEAST node" : "at most 2, 19600 exclusions", dag, root, seconds_since(start));
+    }
+
+    Formula* f = arena.make<And>(at_most(1, 50, false), demands(1));
+    DAG dag;
+    auto start = std::chrono::steady_clock::now();
+    auto root = build_dag(f, dag);
+    double build_secs = seconds_since(start);
+    report_solve("at most 1, 1225 exclusions", dag, root, build_secs);
+    DAG collapsed;
+    CardinalityReport report;
+    start = std::chrono::steady_clock::now();
+    root = collapse_at_most_one(dag, root, collapsed, report);
+    build_secs += seconds_since(start);
+    std::cout << "- " << report.groups << " at-most-one group from " << report.pairs << " exclusions:" << std::endl;
+    report_solve("at most 1, collapsed", collapsed, root, build_secs);
+    arena.reset();
+}
+}
+
+void run_benchmarks() {
+    benchmark_wide_gates();
+    benchmark_build();
+    benchmark_constants();
+    benchmark_aig();
+    benchmark_normalize();
+    benchmark_mux_miter();
+    benchmark_gauss();
+    benchmark_cardinality();
+    benchmark_jit();
+}
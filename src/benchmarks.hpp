@@ -0,0 +1,8 @@
+#ifndef __BENCHMARKS__
+#define __BENCHMARKS__
+
+// Time the alternative implementations of the solver's building blocks against
+// each other on generated formulas and print the results.
+void run_benchmarks();
+
+#endif
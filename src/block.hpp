@@ -0,0 +1,20 @@
+#ifndef __BLOCK__
+#define __BLOCK__
+#include <cstdint>
+
+// A block of bits in as many 64-bit lanes as the widest vector registers of
+// the target have, so that bitwise operations on it compile to single vector
+// instructions.
+#if defined(__AVX512F__)
+typedef uint64_t Block __attribute__((vector_size(64)));
+const unsigned LANE_BITS = 3;
+#elif defined(__AVX2__)
+typedef uint64_t Block __attribute__((vector_size(32)));
+const unsigned LANE_BITS = 2;
+#else
+typedef uint64_t Block __attribute__((vector_size(8)));
+const unsigned LANE_BITS = 0;
+#endif
+const unsigned LANES = 1 << LANE_BITS;
+
+#endif
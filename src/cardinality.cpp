@@ -0,0 +1,260 @@
+#include "cardinality.hpp"
+#include <algorithm>
+
+namespace {
+const uint32_t NO_PLAN = 0xffffffff;
+
+// the nodes a and b (a < b) that node n keeps from being TRUE together, if n
+// is one of the exclusion patterns
+bool exclusion(const DAG& dag, NodeId n, NodeId& a, NodeId& b) {
+    auto kids = dag.children_of(n);
+    switch(dag.ops[n]){
+        case DAGOp::NOT: {
+            auto inner = dag.children_of(kids[0]);
+            if(dag.ops[kids[0]] != DAGOp::AND || inner.size() != 2){
+                return false;
+            }
+            a = inner[0];
+            b = inner[1];
+            break;
+        }
+        case DAGOp::OR:
+            if(kids.size() != 2 || dag.ops[kids[0]] != DAGOp::NOT || dag.ops[kids[1]] != DAGOp::NOT){
+                return false;
+            }
+            a = dag.children_of(kids[0])[0];
+            b = dag.children_of(kids[1])[0];
+            break;
+        case DAGOp::IMPLIES:
+            if(dag.ops[kids[1]] != DAGOp::NOT){
+                return false;
+            }
+            a = kids[0];
+            b = dag.children_of(kids[1])[0];
+            break;
+        default:
+            return false;
+    }
+    if(a > b){
+        std::swap(a, b);
+    }
+    return a != b;
+}
+
+// an exclusion between local vertices a < b, made by child of the gate
+struct Exclusion {
+    uint32_t a;
+    uint32_t b;
+    uint32_t child;
+
+    bool operator<(const Exclusion& other) const {
+        return a != other.a ? a < other.a : b < other.b;
+    }
+};
+
+// How an AND gate is rebuilt: the children it keeps, and the groups of nodes
+// of which at most one holds that stand in for the others.
+struct Plan {
+    std::vector<NodeId> kept;
+    std::vector<std::vector<NodeId>> groups;
+};
+
+// Finds the at-most-one groups among the children of one AND gate.
+struct GroupFinder {
+    const DAG& dag;
+    std::vector<NodeId> vertices;                 // node of each local vertex
+    std::vector<Exclusion> edges;                 // sorted by vertex pair
+    std::vector<std::vector<uint32_t>> adjacent;  // sorted neighbors of each vertex
+    std::vector<uint32_t> open;                   // edges of a vertex not covered by a group
+    std::vector<char> covered;                    // per child of the gate
+
+    explicit GroupFinder(const DAG& dag) : dag(dag) {}
+
+    bool linked(uint32_t u, uint32_t w) const {
+        return std::binary_search(adjacent[u].begin(), adjacent[u].end(), w);
+    }
+
+    // drop the exclusions between u and w, which a group now implies
+    size_t cover(uint32_t u, uint32_t w) {
+        Exclusion key{std::min(u, w), std::max(u, w), 0};
+        auto range = std::equal_range(edges.begin(), edges.end(), key);
+        size_t dropped = 0;
+        for(auto it = range.first; it != range.second; ++it){
+            if(!covered[it->child]){
+                covered[it->child] = 1;
+                dropped++;
+            }
+        }
+        if(dropped > 0){
+            open[u]--;
+            open[w]--;
+        }
+        return dropped;
+    }
+
+    Plan plan(NodeId gate, CardinalityReport& report) {
+        auto kids = dag.children_of(gate);
+        Plan result;
+        vertices.clear();
+        edges.clear();
+        for(uint32_t i = 0; i < kids.size(); i++){
+            NodeId a, b;
+            if(exclusion(dag, kids[i], a, b)){
+                vertices.push_back(a);
+                vertices.push_back(b);
+                edges.push_back({a, b, i});
+            }
+        }
+        if(edges.size() < 3){
+            result.kept.assign(kids.begin(), kids.end());
+            return result;
+        }
+
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        auto local = [&](NodeId n){ return uint32_t(std::lower_bound(vertices.begin(), vertices.end(), n) - vertices.begin()); };
+        adjacent.assign(vertices.size(), {});
+        for(auto& e: edges){
+            e.a = local(e.a);
+            e.b = local(e.b);
+            adjacent[e.a].push_back(e.b);
+            adjacent[e.b].push_back(e.a);
+        }
+        std::sort(edges.begin(), edges.end());
+        open.assign(vertices.size(), 0);
+        for(uint32_t v = 0; v < vertices.size(); v++){
+            auto& n = adjacent[v];
+            std::sort(n.begin(), n.end());
+            n.erase(std::unique(n.begin(), n.end()), n.end());
+            open[v] = n.size();
+        }
+        covered.assign(kids.size(), 0);
+
+        // grow a group from the vertex with the most uncovered exclusions,
+        // trying its uncovered neighbors first, until no vertex can start one
+        std::vector<char> exhausted(vertices.size(), 0);
+        std::vector<uint32_t> group;
+        std::vector<uint32_t> candidates;
+        while(true){
+            uint32_t start = 0;
+            for(uint32_t v = 1; v < vertices.size(); v++){
+                if(exhausted[start] || (!exhausted[v] && open[v] > open[start])){
+                    start = v;
+                }
+            }
+            if(exhausted[start] || open[start] < 2){
+                break;
+            }
+            candidates = adjacent[start];
+            std::stable_sort(candidates.begin(), candidates.end(), [&](uint32_t x, uint32_t y){
+                return open[x] > open[y];
+            });
+            group.assign(1, start);
+            for(auto u: candidates){
+                if(std::all_of(group.begin(), group.end(), [&](uint32_t w){ return linked(u, w); })){
+                    group.push_back(u);
+                }
+            }
+            if(group.size() < 3){
+                exhausted[start] = 1;
+                continue;
+            }
+            size_t dropped = 0;
+            for(size_t i = 0; i < group.size(); i++){
+                for(size_t j = i + 1; j < group.size(); j++){
+                    dropped += cover(group[i], group[j]);
+                }
+            }
+            if(dropped == 0){
+                exhausted[start] = 1;
+                continue;
+            }
+            result.groups.emplace_back();
+            for(auto u: group){
+                result.groups.back().push_back(vertices[u]);
+            }
+            report.groups++;
+            report.pairs += dropped;
+        }
+
+        for(uint32_t i = 0; i < kids.size(); i++){
+            if(!covered[i]){
+                result.kept.push_back(kids[i]);
+            }
+        }
+        return result;
+    }
+};
+}
+
+NodeId collapse_at_most_one(const DAG& dag, NodeId root, DAG& out, CardinalityReport& report) {
+    // children come before their parents, so walking the ids downwards plans
+    // every AND gate of the cone before the nodes it still needs are marked
+    std::vector<char> needed(root + 1, 0);
+    std::vector<uint32_t> plan_of(root + 1, NO_PLAN);
+    std::vector<Plan> plans;
+    GroupFinder finder(dag);
+    needed[root] = 1;
+    for(NodeId n = root + 1; n-- > 0;){
+        if(!needed[n]){
+            continue;
+        }
+        if(dag.ops[n] != DAGOp::AND){
+            for(auto child: dag.children_of(n)){
+                needed[child] = 1;
+            }
+            continue;
+        }
+        Plan plan = finder.plan(n, report);
+        for(auto child: plan.kept){
+            needed[child] = 1;
+        }
+        for(auto& group: plan.groups){
+            for(auto member: group){
+                needed[member] = 1;
+            }
+        }
+        if(!plan.groups.empty()){
+            plan_of[n] = plans.size();
+            plans.push_back(std::move(plan));
+        }
+    }
+
+    std::vector<NodeId> copy(root + 1, NO_NODE);
+    std::vector<NodeId> kids;
+    std::vector<NodeId> members;
+    for(NodeId n = 0; n <= root; n++){
+        if(!needed[n]){
+            continue;
+        }
+        auto op = dag.ops[n];
+        if(op == DAGOp::VAR || op == DAGOp::CONST){
+            copy[n] = op == DAGOp::VAR ? out.make_var(dag.symbol[n]) : out.make_const(dag.const_value(n));
+            continue;
+        }
+        kids.clear();
+        if(plan_of[n] == NO_PLAN){
+            for(auto child: dag.children_of(n)){
+                kids.push_back(copy[child]);
+            }
+        }
+        else{
+            auto& plan = plans[plan_of[n]];
+            for(auto child: plan.kept){
+                kids.push_back(copy[child]);
+            }
+            for(auto& group: plan.groups){
+                members.clear();
+                for(auto member: group){
+                    members.push_back(copy[member]);
+                }
+                NodeId at_least_two = out.make_atleast(2, members.data(), members.size());
+                kids.push_back(out.make_node(DAGOp::NOT, at_least_two));
+            }
+        }
+        copy[n] = op == DAGOp::ATLEAST ? out.make_atleast(dag.bound(n), kids.data(), kids.size())
+                                       : out.make_node(op, kids.data(), kids.size());
+    }
+    out.link_parents();
+    return copy[root];
+}
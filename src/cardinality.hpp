@@ -0,0 +1,21 @@
+#ifndef __CARDINALITY__
+#define __CARDINALITY__
+#include "dagformula.hpp"
+
+// What collapse_at_most_one() replaced.
+struct CardinalityReport {
+    size_t groups = 0;      // at-most-one groups that became a single node
+    size_t pairs = 0;       // pairwise exclusions they made redundant
+};
+
+// Copy the cone of root from dag to out, collapsing pairwise at-most-one
+// encodings into cardinality nodes. Among the children of an AND gate, each of
+// NOT (a AND b), NOT a OR NOT b and a => NOT b excludes a and b being TRUE
+// together; the exclusions form a graph on the nodes they mention, and every
+// clique of three or more nodes found in it greedily says that at most one of
+// them holds, which is the single node NOT ATLEAST(2, ...) in place of its
+// m (m - 1) / 2 exclusions. Exclusions outside the cliques are kept.
+// The parents of out are linked; returns the node of root in out.
+NodeId collapse_at_most_one(const DAG& dag, NodeId root, DAG& out, CardinalityReport& report);
+
+#endif
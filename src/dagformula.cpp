@@ -1,116 +1,399 @@
 #include "dagformula.hpp"
+#include "gauss.hpp"
+#include <algorithm>
 
-DAGNode* build_dag(Formula *f, std::map<std::string, DAGNode*>& node_map, DAGNode* parent) {
-    auto sig = f->signature();
-    if(node_map.count(sig)){
-        auto node = node_map[sig];
-        if(parent){
-            node->parents.push_back(parent);
+namespace {
+const uint32_t NO_SYMBOL = 0xffffffff;
+
+TruthValue opposite(TruthValue value) {
+    return value == TruthValue::TRUE ? TruthValue::FALSE : TruthValue::TRUE;
+}
+}
+
+template<typename Equal>
+NodeId DAG::lookup(uint64_t hash, Equal equal, size_t& slot) {
+    // keep the load factor at most 1/2 so probe sequences stay short
+    if(2 * (size() + 1) > table.size()){
+        grow();
+    }
+    size_t mask = table.size() - 1;
+    for(slot = hash & mask; table[slot].id != NO_NODE; slot = (slot + 1) & mask){
+        if(table[slot].hash == hash && equal(table[slot].id)){
+            return table[slot].id;
         }
-        return node;
     }
+    return NO_NODE;
+}
 
-    DAGNode* node = new DAGNode();
+NodeId DAG::add_node(DAGOp op, const NodeId* kids, uint32_t count, uint32_t sym, uint64_t hash, size_t slot) {
+    NodeId id = size();
+    ops.push_back(op);
+    values.push_back(TruthValue::UNKNOWN);
+    symbol.push_back(sym);
+    children.insert(children.end(), kids, kids + count);
+    child_start.push_back(children.size());
+    table[slot] = {hash, id};
+    return id;
+}
 
-    if(parent){
-        node->parents.push_back(parent);
+void DAG::grow() {
+    std::vector<Slot> old;
+    old.swap(table);
+    table.assign(old.empty() ? 64 : 2 * old.size(), {0, NO_NODE});
+    size_t mask = table.size() - 1;
+    for(auto& entry: old){
+        if(entry.id == NO_NODE){
+            continue;
+        }
+        size_t slot = entry.hash & mask;
+        while(table[slot].id != NO_NODE){
+            slot = (slot + 1) & mask;
+        }
+        table[slot] = entry;
     }
+}
 
-    if (auto var = dynamic_cast<Variable*>(f)) {
-        node->op = DAGOp::VAR;
-        node->var = var->name;
+NodeId DAG::make_var(uint32_t sym) {
+    uint64_t hash = mix64(((uint64_t)DAGOp::VAR << 32) | sym);
+    size_t slot;
+    auto found = lookup(hash, [&](NodeId node){
+        return ops[node] == DAGOp::VAR && symbol[node] == sym;
+    }, slot);
+    if(found != NO_NODE){
+        return found;
     }
-    else if (auto not_op = dynamic_cast<Not*>(f)) {
-        node->op = DAGOp::NOT;
-        node->children.push_back(
-            build_dag(not_op->operand, node_map, node)
-        );
+    return add_node(DAGOp::VAR, nullptr, 0, sym, hash, slot);
+}
+
+NodeId DAG::fold_binary(DAGOp op, NodeId a, NodeId b) {
+    if(a == b){
+        return make_const(op != DAGOp::XOR);
+    }
+    if(op == DAGOp::EQ || op == DAGOp::XOR){
+        // EQ and XOR are commutative: a constant side selects the other side or its negation
+        if(ops[a] == DAGOp::CONST){
+            std::swap(a, b);
+        }
+        if(ops[b] == DAGOp::CONST){
+            return const_value(b) == (op == DAGOp::EQ) ? a : make_node(DAGOp::NOT, a);
+        }
+        return NO_NODE;
     }
-    else if (auto and_op = dynamic_cast<And*>(f)) {
-        node->op = DAGOp::AND;
-        node->children.push_back(build_dag(and_op->left, node_map, node));
-        node->children.push_back(build_dag(and_op->right, node_map, node));
+    if(ops[a] == DAGOp::CONST){
+        return const_value(a) ? b : make_const(true);
+    }
+    if(ops[b] == DAGOp::CONST){
+        return const_value(b) ? make_const(true) : make_node(DAGOp::NOT, a);
+    }
+    return NO_NODE;
+}
+
+NodeId DAG::fold_ite(NodeId c, NodeId t, NodeId e) {
+    if(ops[c] == DAGOp::CONST){
+        return const_value(c) ? t : e;
     }
-    else if (auto or_op = dynamic_cast<Or*>(f)) {
-        node->op = DAGOp::OR;
-        node->children.push_back(build_dag(or_op->left, node_map, node));
-        node->children.push_back(build_dag(or_op->right, node_map, node));
+    if(t == e){
+        return t;
     }
-    else if (auto impl = dynamic_cast<Implies*>(f)) {
-        node->op = DAGOp::IMPLIES;
-        node->children.push_back(build_dag(impl->left, node_map, node));
-        node->children.push_back(build_dag(impl->right, node_map, node));
+    // a branch equal to the condition takes its value exactly where it is selected
+    if(t == c || (ops[t] == DAGOp::CONST && const_value(t))){
+        return make_node(DAGOp::OR, c, e);
     }
-    else if (auto eq = dynamic_cast<Eq*>(f)) {
-        node->op = DAGOp::EQ;
-        node->children.push_back(build_dag(eq->left, node_map, node));
-        node->children.push_back(build_dag(eq->right, node_map, node));
+    if(e == c || (ops[e] == DAGOp::CONST && !const_value(e))){
+        return make_node(DAGOp::AND, c, t);
     }
+    if(ops[t] == DAGOp::CONST){
+        return make_node(DAGOp::AND, make_node(DAGOp::NOT, c), e);
+    }
+    if(ops[e] == DAGOp::CONST){
+        return make_node(DAGOp::IMPLIES, c, t);
+    }
+    return NO_NODE;
+}
 
-    node_map[sig] = node;
-    return node;
+NodeId DAG::make_const(bool value) {
+    uint64_t hash = mix64(((uint64_t)DAGOp::CONST << 32) | value);
+    size_t slot;
+    auto found = lookup(hash, [&](NodeId node){
+        return ops[node] == DAGOp::CONST && const_value(node) == value;
+    }, slot);
+    if(found != NO_NODE){
+        return found;
+    }
+    return add_node(DAGOp::CONST, nullptr, 0, value, hash, slot);
 }
 
-void DAGNode::print() const {
-    switch (op) {
-        case DAGOp::VAR:
-            std::cout << var;
-            break;
-        case DAGOp::NOT:
-            std::cout << "NOT(";
-            children[0]->print();
-            std::cout << ")";
-            break;
-        case DAGOp::AND:
-            std::cout << "AND(";
-            children[0]->print();
-            std::cout << ",";
-            children[1]->print();
-            std::cout << ")";
-            break;
-        case DAGOp::OR:
-            std::cout << "OR(";
-            children[0]->print();
-            std::cout << ",";
-            children[1]->print();
-            std::cout << ")";
-            break;
-        case DAGOp::IMPLIES:
-            std::cout << "IMP(";
-            children[0]->print();
-            std::cout << ",";
-            children[1]->print();
-            std::cout << ")";
-            break;
-        case DAGOp::EQ:
-            std::cout << "EQ(";
-            children[0]->print();
-            std::cout << ",";
-            children[1]->print();
-            std::cout << ")";
-            break;
+NodeId DAG::make_node(DAGOp op, NodeId left, NodeId right) {
+    NodeId kids[2] = {left, right};
+    return make_node(op, kids, right == NO_NODE ? 1 : 2);
+}
+
+NodeId DAG::make_node(DAGOp op, NodeId* kids, uint32_t count) {
+    //in order to share logically equivalent nodes, the children of
+    //commutative operators are ordered by id
+    if(op == DAGOp::AND || op == DAGOp::OR || op == DAGOp::EQ || op == DAGOp::XOR){
+        std::sort(kids, kids + count);
+    }
+    if(op == DAGOp::AND || op == DAGOp::OR){
+        // TRUE (FALSE) children of an AND (OR) drop out, and a FALSE (TRUE)
+        // child or a pair x, NOT x decides the gate
+        bool absorbing = op == DAGOp::OR;
+        uint32_t kept = 0;
+        for(uint32_t i = 0; i < count; i++){
+            if(ops[kids[i]] != DAGOp::CONST){
+                kids[kept++] = kids[i];
+            }
+            else if(const_value(kids[i]) == absorbing){
+                folded_gates++;
+                return make_const(absorbing);
+            }
+        }
+        if(kept < count){
+            folded_gates++;
+        }
+        count = std::unique(kids, kids + kept) - kids;
+        if(count == 0){
+            return make_const(!absorbing);
+        }
+        if(count == 1){
+            return kids[0];
+        }
+        for(uint32_t i = 0; i < count; i++){
+            if(ops[kids[i]] == DAGOp::NOT && std::binary_search(kids, kids + count, children[child_start[kids[i]]])){
+                complementary_gates++;
+                return make_const(absorbing);
+            }
+        }
+    }
+    else if(op == DAGOp::NOT && ops[kids[0]] == DAGOp::CONST){
+        folded_gates++;
+        return make_const(!const_value(kids[0]));
+    }
+    else if(op == DAGOp::IMPLIES || op == DAGOp::EQ || op == DAGOp::XOR){
+        NodeId folded = fold_binary(op, kids[0], kids[1]);
+        if(folded != NO_NODE){
+            folded_gates++;
+            return folded;
+        }
+    }
+    else if(op == DAGOp::ITE){
+        NodeId folded = fold_ite(kids[0], kids[1], kids[2]);
+        if(folded != NO_NODE){
+            folded_gates++;
+            return folded;
+        }
+    }
+
+    return intern(op, kids, count, NO_SYMBOL);
+}
+
+NodeId DAG::make_atleast(uint32_t bound, NodeId* kids, uint32_t count) {
+    // a TRUE child counts towards the bound and a FALSE one never does
+    uint32_t kept = 0;
+    for(uint32_t i = 0; i < count; i++){
+        if(ops[kids[i]] != DAGOp::CONST){
+            kids[kept++] = kids[i];
+        }
+        else if(const_value(kids[i]) && bound > 0){
+            bound--;
+        }
+    }
+    if(kept < count){
+        folded_gates++;
+    }
+    count = kept;
+    if(bound == 0 || bound > count){
+        return make_const(bound == 0);
+    }
+    if(bound == 1 || bound == count){
+        return make_node(bound == 1 ? DAGOp::OR : DAGOp::AND, kids, count);
+    }
+    std::sort(kids, kids + count);
+    return intern(DAGOp::ATLEAST, kids, count, bound);
+}
+
+NodeId DAG::intern(DAGOp op, const NodeId* kids, uint32_t count, uint32_t sym) {
+    uint64_t hash = mix64(((uint64_t)op << 32) | count);
+    for(uint32_t i = 0; i < count; i++){
+        hash = mix64(hash ^ kids[i]);
+    }
+    if(sym != NO_SYMBOL){
+        hash = mix64(hash ^ ((uint64_t)sym << 32));
+    }
+    size_t slot;
+    auto found = lookup(hash, [&](NodeId node){
+        auto other = children_of(node);
+        return ops[node] == op && symbol[node] == sym && other.size() == count && std::equal(other.begin(), other.end(), kids);
+    }, slot);
+    if(found != NO_NODE){
+        return found;
+    }
+    return add_node(op, kids, count, sym, hash, slot);
+}
+
+void DAG::link_parents() {
+    // count the parents of every node, turn the counts into start offsets,
+    // then fill each node's run in the order the parents were created
+    parent_start.assign(size() + 1, 0);
+    for(auto child: children){
+        parent_start[child + 1]++;
+    }
+    for(size_t n = 0; n < size(); n++){
+        parent_start[n + 1] += parent_start[n];
     }
+    parents.resize(children.size());
+    std::vector<uint32_t> fill(parent_start.begin(), parent_start.end() - 1);
+    for(NodeId n = 0; n < size(); n++){
+        for(auto child: children_of(n)){
+            parents[fill[child]++] = n;
+        }
+    }
+}
+
+void DAG::clear() {
+    ops.clear();
+    values.clear();
+    child_start.assign(1, 0);
+    children.clear();
+    parent_start.clear();
+    parents.clear();
+    symbol.clear();
+    complementary_gates = 0;
+    folded_gates = 0;
+    std::fill(table.begin(), table.end(), Slot{0, NO_NODE});
+}
 
+size_t DAG::memory_bytes() const {
+    return ops.capacity() * sizeof(DAGOp)
+        + values.capacity() * sizeof(TruthValue)
+        + (child_start.capacity() + parent_start.capacity() + symbol.capacity()) * sizeof(uint32_t)
+        + (children.capacity() + parents.capacity()) * sizeof(NodeId)
+        + table.capacity() * sizeof(Slot);
 }
 
-bool DAGNode::propagate_children(TruthValue new_value, int level) {
-    switch (op)
+namespace {
+// adds one formula node to the DAG, given the DAG nodes of its operands
+struct DAGBuilder {
+    DAG& dag;
+    NodeId* kids;
+    uint32_t count;
+
+    NodeId operator()(const Variable* var) { return dag.make_var(var->id); }
+    NodeId operator()(const Constant* c) { return dag.make_const(c->value); }
+    NodeId operator()(const Not*) { return dag.make_node(DAGOp::NOT, kids[0]); }
+    NodeId operator()(const And*) { return dag.make_node(DAGOp::AND, kids, count); }
+    NodeId operator()(const Or*) { return dag.make_node(DAGOp::OR, kids, count); }
+    NodeId operator()(const Implies*) { return dag.make_node(DAGOp::IMPLIES, kids[0], kids[1]); }
+    NodeId operator()(const Eq*) { return dag.make_node(DAGOp::EQ, kids[0], kids[1]); }
+    NodeId operator()(const Xor*) { return dag.make_node(DAGOp::XOR, kids[0], kids[1]); }
+    NodeId operator()(const Ite*) { return dag.make_node(DAGOp::ITE, kids, 3); }
+    NodeId operator()(const AtLeast* a) { return dag.make_atleast(a->bound, kids, count); }
+};
+
+// A formula node being built and its operands: the subformulas below the
+// maximal chain of ANDs (or ORs) that starts at an AND (OR) node, and the
+// children of any other node.
+struct BuildFrame {
+    const Formula* node;
+    size_t first;   // operands[first .. last-1]
+    size_t last;
+    size_t next;    // next operand to build
+};
+}
+
+NodeId build_dag(Formula *f, DAG& dag) {
+    // post-order with explicit stacks like fold(), except that the inner nodes
+    // of an associative chain are skipped, so the chain becomes one n-ary gate
+    std::vector<const Formula*> operands;
+    std::vector<const Formula*> chain;
+    std::vector<NodeId> values;
+    std::vector<BuildFrame> stack;
+    auto push = [&](const Formula* node){
+        size_t first = operands.size();
+        if(node->op == FormulaOp::AND || node->op == FormulaOp::OR){
+            chain.push_back(node);
+            while(!chain.empty()){
+                auto inner = chain.back();
+                chain.pop_back();
+                for(size_t i = 0; i < inner->arity(); i++){
+                    auto child = inner->child(i);
+                    (child->op == node->op ? chain : operands).push_back(child);
+                }
+            }
+        }
+        else{
+            for(size_t i = 0; i < node->arity(); i++){
+                operands.push_back(node->child(i));
+            }
+        }
+        stack.push_back({node, first, operands.size(), first});
+    };
+
+    push(f);
+    while(!stack.empty()){
+        auto& top = stack.back();
+        if(top.next < top.last){
+            push(operands[top.next++]);
+            continue;
+        }
+        uint32_t count = top.last - top.first;
+        NodeId* kids = values.data() + values.size() - count;
+        NodeId id = visit(top.node, DAGBuilder{dag, kids, count});
+        values.resize(values.size() - count);
+        operands.resize(top.first);
+        stack.pop_back();
+        values.push_back(id);
+    }
+    dag.link_parents();
+    return values.back();
+}
+
+void DAG::print(NodeId node) const {
+    static const char* names[] = {"", "NOT", "AND", "OR", "IMP", "EQ", "", "XOR", "ITE", "ATLEAST"};
+    // explicit stack of (node, index of the next child to print)
+    std::vector<std::pair<NodeId, size_t>> stack{{node, 0}};
+    while(!stack.empty()){
+        NodeId n = stack.back().first;
+        size_t i = stack.back().second++;
+        if(ops[n] == DAGOp::VAR || ops[n] == DAGOp::CONST){
+            std::cout << (ops[n] == DAGOp::VAR ? var_name(n) : const_value(n) ? "true" : "false");
+            stack.pop_back();
+            continue;
+        }
+        auto kids = children_of(n);
+        if(i == kids.size()){
+            std::cout << ")";
+            stack.pop_back();
+            continue;
+        }
+        std::cout << (i == 0 ? names[(int)ops[n]] + std::string("(") : ",");
+        if(i == 0 && ops[n] == DAGOp::ATLEAST){
+            std::cout << bound(n) << ",";
+        }
+        stack.push_back({kids[i], 0});
+    }
+}
+
+bool Propagator::propagate_children(NodeId node, TruthValue new_value) {
+    auto children = dag.children_of(node);
+    switch (dag.ops[node])
     {
         case DAGOp::VAR:
-        // Variable nodes have no children to propagate to, so we can just return true.
+        case DAGOp::CONST:
+        // Variable and constant nodes have no children to propagate to, so we can just return true.
         return true;
             break;
         case DAGOp::NOT:
 
         //If the NOT node becomes TRUE, propagate FALSE to its child.
         if(new_value == TruthValue::TRUE){
-            if(!children[0]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+            if(!assign(children[0], TruthValue::FALSE, node)){
                 return false;
             }
         }
         //If the NOT node becomes FALSE, propagate TRUE to its child.
         if(new_value == TruthValue::FALSE){
-            if(!children[0]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+            if(!assign(children[0], TruthValue::TRUE, node)){
                 return false;
             }
         }
@@ -119,29 +402,15 @@ bool DAGNode::propagate_children(TruthValue new_value, int level) {
          //  If the AND node becomes TRUE, propagate TRUE to all of its children.
         if(new_value == TruthValue::TRUE){
             for(auto child: children){
-                if(!child->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(!assign(child, TruthValue::TRUE, node)){
                     return false;
                 }
             }
         }
         // If the AND node is FALSE and all but one child are TRUE, propagate FALSE to the remaining unlabeled 
         if(new_value == TruthValue::FALSE){
-            DAGNode* unlabeled_child = nullptr;
-            bool more_than_one_unlabeled = false;
-            for(auto child: children){
-                if(child->truth_value == TruthValue::UNKNOWN){
-                    if(unlabeled_child == nullptr){
-                        unlabeled_child = child;
-                    } else {
-                        more_than_one_unlabeled = true;
-                    }
-                }
-            }
-
-            if(unlabeled_child && !more_than_one_unlabeled){
-                if(!unlabeled_child->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
-                    return false;
-                }
+            if(!propagate_last_open_child(node)){
+                return false;
             }
         }
             break;
@@ -149,53 +418,36 @@ bool DAGNode::propagate_children(TruthValue new_value, int level) {
             // If the OR node becomes FALSE, propagate FALSE to all children.
             if(new_value == TruthValue::FALSE){
                 for(auto child: children){
-                    if(!child->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                    if(!assign(child, TruthValue::FALSE, node)){
                         return false;
                     }
                 }
             }
             // If the OR node is TRUE and all but one child are FALSE, propagate TRUE to the remaining unlabeled child.
             if(new_value == TruthValue::TRUE){
-                DAGNode* unlabeled_child = nullptr;
-                bool more_than_one_unlabeled = false;
-                bool any_non_false = false;
-                for(auto child: children){
-                    if(child->truth_value == TruthValue::UNKNOWN){
-                        if(unlabeled_child == nullptr){
-                            unlabeled_child = child;
-                        } else {
-                            more_than_one_unlabeled = true;
-                        }
-                    } else if(child->truth_value != TruthValue::FALSE){
-                        any_non_false = true;
-                    }
-                }
-
-                if(!any_non_false && unlabeled_child && !more_than_one_unlabeled){
-                    if(!unlabeled_child->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
-                        return false;
-                    }
+                if(!propagate_last_open_child(node)){
+                    return false;
                 }
             }
             break;
         case DAGOp::IMPLIES:
             // Let A = children[0], B = children[1]
             if(new_value == TruthValue::FALSE){
-                if(!children[0]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(!assign(children[0], TruthValue::TRUE, node)){
                     return false;
                 }
-                if(!children[1]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(!assign(children[1], TruthValue::FALSE, node)){
                     return false;
                 }
             }
             if(new_value == TruthValue::TRUE){
-                if(children[0]->truth_value == TruthValue::TRUE){
-                    if(!children[1]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[children[0]] == TruthValue::TRUE){
+                    if(!assign(children[1], TruthValue::TRUE, node)){
                         return false;
                     }
                 }
-                if(children[1]->truth_value == TruthValue::FALSE){
-                    if(!children[0]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[children[1]] == TruthValue::FALSE){
+                    if(!assign(children[0], TruthValue::FALSE, node)){
                         return false;
                     }
                 }
@@ -204,65 +456,113 @@ bool DAGNode::propagate_children(TruthValue new_value, int level) {
         case DAGOp::EQ:
             if(new_value == TruthValue::TRUE){
                 // If one side is known, force the other to the same value.
-                if(children[0]->truth_value == TruthValue::TRUE){
-                    if(!children[1]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[children[0]] == TruthValue::TRUE){
+                    if(!assign(children[1], TruthValue::TRUE, node)){
                         return false;
                     }
-                } else if(children[0]->truth_value == TruthValue::FALSE){
-                    if(!children[1]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                } else if(dag.values[children[0]] == TruthValue::FALSE){
+                    if(!assign(children[1], TruthValue::FALSE, node)){
                         return false;
                     }
                 }
 
-                if(children[1]->truth_value == TruthValue::TRUE){
-                    if(!children[0]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[children[1]] == TruthValue::TRUE){
+                    if(!assign(children[0], TruthValue::TRUE, node)){
                         return false;
                     }
-                } else if(children[1]->truth_value == TruthValue::FALSE){
-                    if(!children[0]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                } else if(dag.values[children[1]] == TruthValue::FALSE){
+                    if(!assign(children[0], TruthValue::FALSE, node)){
                         return false;
                     }
                 }
             }
             if(new_value == TruthValue::FALSE){
                 // If one side is known, force the other to the opposite value.
-                if(children[0]->truth_value == TruthValue::TRUE){
-                    if(!children[1]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[children[0]] == TruthValue::TRUE){
+                    if(!assign(children[1], TruthValue::FALSE, node)){
                         return false;
                     }
-                } else if(children[0]->truth_value == TruthValue::FALSE){
-                    if(!children[1]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                } else if(dag.values[children[0]] == TruthValue::FALSE){
+                    if(!assign(children[1], TruthValue::TRUE, node)){
                         return false;
                     }
                 }
 
-                if(children[1]->truth_value == TruthValue::TRUE){
-                    if(!children[0]->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[children[1]] == TruthValue::TRUE){
+                    if(!assign(children[0], TruthValue::FALSE, node)){
                         return false;
                     }
-                } else if(children[1]->truth_value == TruthValue::FALSE){
-                    if(!children[0]->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                } else if(dag.values[children[1]] == TruthValue::FALSE){
+                    if(!assign(children[0], TruthValue::TRUE, node)){
                         return false;
                     }
                 }
             }
             break;
+        case DAGOp::XOR:
+            // If one side is known, the other side is its value XOR the node's value.
+            for(int i = 0; i < 2; i++){
+                auto known = dag.values[children[i]];
+                if(known != TruthValue::UNKNOWN){
+                    auto other = new_value == TruthValue::TRUE ? opposite(known) : known;
+                    if(!assign(children[1 - i], other, node)){
+                        return false;
+                    }
+                }
+            }
+            break;
+        case DAGOp::ITE: {
+            // Let C = children[0], T = children[1], E = children[2]
+            auto condition = dag.values[children[0]];
+            // A known condition selects the branch that takes the node's value.
+            if(condition == TruthValue::TRUE){
+                if(!assign(children[1], new_value, node)){
+                    return false;
+                }
+            } else if(condition == TruthValue::FALSE){
+                if(!assign(children[2], new_value, node)){
+                    return false;
+                }
+            }
+            // A branch with the other value cannot be the selected one.
+            auto then_value = dag.values[children[1]];
+            auto else_value = dag.values[children[2]];
+            if(then_value != TruthValue::UNKNOWN && then_value != new_value){
+                if(!assign(children[0], TruthValue::FALSE, node)){
+                    return false;
+                }
+            }
+            if(else_value != TruthValue::UNKNOWN && else_value != new_value){
+                if(!assign(children[0], TruthValue::TRUE, node)){
+                    return false;
+                }
+            }
+        }
+            break;
+        case DAGOp::ATLEAST:
+            // A TRUE node without a FALSE child to spare needs every open child
+            // TRUE, a FALSE node one TRUE child below the bound every one FALSE.
+            if(!propagate_cardinality(node)){
+                return false;
+            }
+            break;
     };
     return true;
 }
 
-bool DAGNode::propagate_parents(TruthValue new_value, int level) {
-    for(auto parent:parents){
-        switch(parent->op){
+bool Propagator::propagate_parents(NodeId node, TruthValue new_value) {
+    for(auto parent: dag.parents_of(node)){
+        auto siblings = dag.children_of(parent);
+        switch(dag.ops[parent]){
             case DAGOp::NOT:
                 if(new_value == TruthValue::TRUE){
-                    if(!parent->label(TruthValue::FALSE,level+1,TruthValueChangeReason::TRIGGER)){
+                    if(!assign(parent, TruthValue::FALSE, parent)){
                         return false;
                     }
                 }
 
                 if(new_value == TruthValue::FALSE){
-                    if(!parent->label(TruthValue::TRUE,level+1,TruthValueChangeReason::TRIGGER)){
+                    if(!assign(parent, TruthValue::TRUE, parent)){
                         return false;
                     }
                 }
@@ -271,23 +571,14 @@ bool DAGNode::propagate_parents(TruthValue new_value, int level) {
             case DAGOp::AND: {
                 // If any child becomes FALSE, the AND becomes FALSE (rule 3 bottom-up).
                 if(new_value == TruthValue::FALSE){
-                    if(!parent->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                    if(!assign(parent, TruthValue::FALSE, parent)){
                         return false;
                     }
                 }
                 // If all children are TRUE, the AND becomes TRUE (rule 4 bottom-up).
                 else if(new_value == TruthValue::TRUE){
-                    bool all_true = true;
-                    for(auto sib : parent->children){
-                        if(sib->truth_value != TruthValue::TRUE){
-                            all_true = false;
-                            break;
-                        }
-                    }
-                    if(all_true){
-                        if(!parent->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
-                            return false;
-                        }
+                    if(!update_gate_watch(parent, node)){
+                        return false;
                     }
                 }
             }
@@ -296,62 +587,57 @@ bool DAGNode::propagate_parents(TruthValue new_value, int level) {
             case DAGOp::OR: {
                 // If any child becomes TRUE, the OR becomes TRUE (rule 3 bottom-up).
                 if(new_value == TruthValue::TRUE){
-                    if(!parent->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                    if(!assign(parent, TruthValue::TRUE, parent)){
                         return false;
                     }
                 }
                 // If all children are FALSE, the OR becomes FALSE (rule 4 bottom-up).
                 else if(new_value == TruthValue::FALSE){
-                    bool all_false = true;
-                    for(auto sib : parent->children){
-                        if(sib->truth_value != TruthValue::FALSE){
-                            all_false = false;
-                            break;
-                        }
-                    }
-                    if(all_false){
-                        if(!parent->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
-                            return false;
-                        }
+                    if(!update_gate_watch(parent, node)){
+                        return false;
                     }
                 }
             }
             break;
 
             case DAGOp::IMPLIES: {
-                DAGNode* a = parent->children[0];
-                DAGNode* b = parent->children[1];
+                NodeId a = siblings[0];
+                NodeId b = siblings[1];
 
                 // If antecedent is FALSE -> implication TRUE (rule 2 bottom-up).
-                if(a->truth_value == TruthValue::FALSE){
-                    if(!parent->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[a] == TruthValue::FALSE){
+                    if(!assign(parent, TruthValue::TRUE, parent)){
                         return false;
                     }
                     break;
                 }
                 // If consequent is TRUE -> implication TRUE (rule 3 bottom-up).
-                if(b->truth_value == TruthValue::TRUE){
-                    if(!parent->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[b] == TruthValue::TRUE){
+                    if(!assign(parent, TruthValue::TRUE, parent)){
                         return false;
                     }
                     break;
                 }
                 // If antecedent TRUE and consequent FALSE -> implication FALSE (truth-table).
-                if(a->truth_value == TruthValue::TRUE && b->truth_value == TruthValue::FALSE){
-                    if(!parent->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(dag.values[a] == TruthValue::TRUE && dag.values[b] == TruthValue::FALSE){
+                    if(!assign(parent, TruthValue::FALSE, parent)){
                         return false;
                     }
                 }
+            }
+            break;
+
+            case DAGOp::EQ: {
+                auto left_val = dag.values[siblings[0]];
+                auto right_val = dag.values[siblings[1]];
 
-                // If the implication is already TRUE, push consequences when children change (forward + contrapositive).
-                if(parent->truth_value == TruthValue::TRUE){
-                    if(a->truth_value == TruthValue::TRUE){
-                        if(!b->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
+                if(left_val != TruthValue::UNKNOWN && right_val != TruthValue::UNKNOWN){
+                    if(left_val == right_val){
+                        if(!assign(parent, TruthValue::TRUE, parent)){
                             return false;
                         }
-                    }
-                    if(b->truth_value == TruthValue::FALSE){
-                        if(!a->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
+                    } else {
+                        if(!assign(parent, TruthValue::FALSE, parent)){
                             return false;
                         }
                     }
@@ -359,54 +645,422 @@ bool DAGNode::propagate_parents(TruthValue new_value, int level) {
             }
             break;
 
-            case DAGOp::EQ: {
-                auto left_val = parent->children[0]->truth_value;
-                auto right_val = parent->children[1]->truth_value;
+            case DAGOp::XOR: {
+                auto left_val = dag.values[siblings[0]];
+                auto right_val = dag.values[siblings[1]];
 
                 if(left_val != TruthValue::UNKNOWN && right_val != TruthValue::UNKNOWN){
-                    if(left_val == right_val){
-                        if(!parent->label(TruthValue::TRUE, level+1, TruthValueChangeReason::TRIGGER)){
-                            return false;
+                    if(!assign(parent, left_val == right_val ? TruthValue::FALSE : TruthValue::TRUE, parent)){
+                        return false;
+                    }
+                }
+            }
+            break;
+
+            case DAGOp::ITE: {
+                auto condition = dag.values[siblings[0]];
+                auto then_value = dag.values[siblings[1]];
+                auto else_value = dag.values[siblings[2]];
+
+                // The selected branch decides the node, and so do two equal branches.
+                auto selected = condition == TruthValue::TRUE ? then_value
+                              : condition == TruthValue::FALSE ? else_value
+                              : then_value == else_value ? then_value : TruthValue::UNKNOWN;
+                if(selected != TruthValue::UNKNOWN){
+                    if(!assign(parent, selected, parent)){
+                        return false;
+                    }
+                }
+            }
+            break;
+
+            case DAGOp::ATLEAST: {
+                // The counters already include this label: bound TRUE children
+                // make the node TRUE, too few children left open or TRUE make it FALSE.
+                uint32_t bound = dag.bound(parent);
+                if(true_count[parent] >= bound){
+                    if(!assign(parent, TruthValue::TRUE, parent)){
+                        return false;
+                    }
+                } else if(siblings.size() - false_count[parent] < bound){
+                    if(!assign(parent, TruthValue::FALSE, parent)){
+                        return false;
+                    }
+                }
+                // Only a label against the node's value can use up its slack.
+                auto parent_value = dag.values[parent];
+                if(parent_value != TruthValue::UNKNOWN && parent_value != new_value){
+                    if(!propagate_cardinality(parent)){
+                        return false;
+                    }
+                }
+            }
+            break;
+
+            default:
+            // variables and constants are never parents
+            break;
+        }
+
+        // A labeled parent re-applies its top-down rules: the change of this child
+        // may complete their condition, e.g. the antecedent of a TRUE implication
+        // becoming TRUE. AND and OR gates get that from their watches instead, and
+        // ATLEAST nodes from their counters.
+        auto parent_op = dag.ops[parent];
+        if(dag.values[parent] != TruthValue::UNKNOWN && parent_op != DAGOp::AND && parent_op != DAGOp::OR
+            && parent_op != DAGOp::ATLEAST){
+            if(!propagate_children(parent, dag.values[parent])){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Propagator::update_gate_watch(NodeId gate, NodeId child) {
+    auto& w = gate_watches[gate];
+    if(child != w[0] && child != w[1]){
+        return true;
+    }
+    if(child == w[0]){
+        std::swap(w[0], w[1]);
+    }
+
+    // look for another child without the neutral value to watch instead,
+    // resuming where the last search of this gate stopped
+    auto neutral = dag.ops[gate] == DAGOp::AND ? TruthValue::TRUE : TruthValue::FALSE;
+    auto children = dag.children_of(gate);
+    uint32_t count = children.size();
+    uint32_t k = watch_cursor[gate];
+    for(uint32_t step = 0; step < count; step++, k = k + 1 == count ? 0 : k + 1){
+        NodeId candidate = children[k];
+        if(candidate != w[0] && candidate != w[1] && dag.values[candidate] != neutral){
+            w[1] = candidate;
+            watch_cursor[gate] = k + 1 == count ? 0 : k + 1;
+            return true;
+        }
+    }
+
+    // every child but w[0] is neutral
+    if(dag.values[w[0]] == neutral){
+        return assign(gate, neutral, gate);
+    }
+    return dag.values[gate] == TruthValue::UNKNOWN || dag.values[gate] == neutral || propagate_last_open_child(gate);
+}
+
+bool Propagator::propagate_last_open_child(NodeId gate) {
+    auto neutral = dag.ops[gate] == DAGOp::AND ? TruthValue::TRUE : TruthValue::FALSE;
+    auto absorbing = neutral == TruthValue::TRUE ? TruthValue::FALSE : TruthValue::TRUE;
+    auto& w = gate_watches[gate];
+    // a neutral watch vouches for the other children only once its own label has
+    // been propagated; until then its watch may still move
+    for(int i = 0; i < 2; i++){
+        if(dag.values[w[i]] == neutral && trail_index[w[i]] < head && dag.values[w[1 - i]] == TruthValue::UNKNOWN){
+            return assign(w[1 - i], absorbing, gate);
+        }
+    }
+    return true;
+}
+
+void Propagator::count_label(NodeId node, TruthValue value, int delta) {
+    auto& counts = value == TruthValue::TRUE ? true_count : false_count;
+    for(auto parent: dag.parents_of(node)){
+        if(dag.ops[parent] == DAGOp::ATLEAST){
+            counts[parent] += delta;
+        }
+    }
+}
+
+bool Propagator::propagate_cardinality(NodeId gate) {
+    auto value = dag.values[gate];
+    auto children = dag.children_of(gate);
+    bool tight = value == TruthValue::TRUE ? children.size() - false_count[gate] == dag.bound(gate)
+                                           : true_count[gate] + 1 == dag.bound(gate);
+    if(!tight){
+        return true;
+    }
+    // a child labeled against the gate but not propagated yet is caught by the
+    // bottom-up rule when its turn comes
+    for(auto child: children){
+        if(dag.values[child] == TruthValue::UNKNOWN && !assign(child, value, gate)){
+            return false;
+        }
+    }
+    return true;
+}
+
+void Propagator::explain_rule(NodeId gate, NodeId implied, TruthValue value, size_t limit, std::vector<NodeId>& out) const {
+    auto labeled_before = [&](NodeId node){
+        return dag.values[node] != TruthValue::UNKNOWN && trail_index[node] < limit;
+    };
+    auto children = dag.children_of(gate);
+    auto op = dag.ops[gate];
+
+    if(implied == gate){
+        // bottom-up rule: the label follows from the children
+        switch(op){
+            case DAGOp::AND:
+            case DAGOp::OR: {
+                // a single child with the absorbing value decides the node,
+                // otherwise all children took part
+                auto absorbing = op == DAGOp::AND ? TruthValue::FALSE : TruthValue::TRUE;
+                if(value == absorbing){
+                    NodeId latest = NO_NODE;
+                    for(auto child: children){
+                        if(dag.values[child] == absorbing && labeled_before(child)
+                            && (latest == NO_NODE || trail_index[child] > trail_index[latest])){
+                            latest = child;
                         }
+                    }
+                    if(latest != NO_NODE){
+                        out.push_back(latest);
+                    }
+                    return;
+                }
+            }
+            break;
+            case DAGOp::IMPLIES:
+                // a FALSE antecedent or a TRUE consequent decides a TRUE implication
+                if(value == TruthValue::TRUE){
+                    if(dag.values[children[0]] == TruthValue::FALSE && labeled_before(children[0])){
+                        out.push_back(children[0]);
                     } else {
-                        if(!parent->label(TruthValue::FALSE, level+1, TruthValueChangeReason::TRIGGER)){
-                            return false;
-                        }
+                        out.push_back(children[1]);
+                    }
+                    return;
+                }
+            break;
+            case DAGOp::ATLEAST: {
+                // bound TRUE children, or one FALSE child more than the node can spare
+                size_t needed = value == TruthValue::TRUE ? dag.bound(gate) : children.size() - dag.bound(gate) + 1;
+                for(auto child: children){
+                    if(needed > 0 && dag.values[child] == value && labeled_before(child)){
+                        out.push_back(child);
+                        needed--;
+                    }
+                }
+                return;
+            }
+            case DAGOp::ITE: {
+                // the condition and the branch it selects, or two equal branches
+                auto condition = dag.values[children[0]];
+                if(labeled_before(children[0]) && condition != TruthValue::UNKNOWN){
+                    NodeId selected = children[condition == TruthValue::TRUE ? 1 : 2];
+                    if(labeled_before(selected) && dag.values[selected] == value){
+                        out.push_back(children[0]);
+                        out.push_back(selected);
+                        return;
                     }
                 }
             }
             break;
+            default:
+            break;
+        }
+        for(auto child: children){
+            if(labeled_before(child)){
+                out.push_back(child);
+            }
+        }
+        return;
+    }
+
+    // top-down rule of the gate: its own label, plus the other children unless
+    // the label alone forces every child
+    out.push_back(gate);
+    auto gate_value = dag.values[gate];
+    if(op == DAGOp::NOT
+        || (op == DAGOp::AND && gate_value == TruthValue::TRUE)
+        || (op == DAGOp::OR && gate_value == TruthValue::FALSE)
+        || (op == DAGOp::IMPLIES && gate_value == TruthValue::FALSE)){
+        return;
+    }
+    if(op == DAGOp::ITE){
+        // a branch follows from the condition that selects it, the condition
+        // from the branch that disagrees with the gate
+        out.push_back(implied == children[0] ? (value == TruthValue::FALSE ? children[1] : children[2]) : children[0]);
+        return;
+    }
+    if(op == DAGOp::ATLEAST){
+        // the children that used up the slack: FALSE ones of a TRUE gate and
+        // TRUE ones of a FALSE gate
+        auto spent = opposite(gate_value);
+        for(auto child: children){
+            if(child != implied && dag.values[child] == spent && labeled_before(child)){
+                out.push_back(child);
+            }
+        }
+        return;
+    }
+    for(auto child: children){
+        if(child != implied && labeled_before(child)){
+            out.push_back(child);
+        }
+    }
+}
+
+Propagator::Propagator(DAG& dag)
+    : dag(dag), trail_index(dag.size(), 0), watches(dag.size()), gate_watches(dag.size()), watch_cursor(dag.size(), 0) {
+    for(NodeId node = 0; node < dag.size(); node++){
+        if(dag.ops[node] == DAGOp::AND || dag.ops[node] == DAGOp::OR){
+            auto children = dag.children_of(node);
+            gate_watches[node] = {children[0], children[1]};
+        }
+        if(dag.ops[node] == DAGOp::ATLEAST && true_count.empty()){
+            true_count.assign(dag.size(), 0);
+            false_count.assign(dag.size(), 0);
         }
     }
-    return true;
 }
 
-bool DAGNode::label(TruthValue new_value, int level, TruthValueChangeReason reason) {
-    if(truth_value == TruthValue::TRUE && new_value == TruthValue::FALSE || truth_value == TruthValue::FALSE && new_value == TruthValue::TRUE){
+bool Propagator::assign(NodeId node, TruthValue new_value, NodeId reason, int clause) {
+    auto old_value = dag.values[node];
+    if(old_value != TruthValue::UNKNOWN && old_value != new_value){
+        conflict_node = node;
+        conflict_value = new_value;
+        conflict_reason = reason;
+        conflict_clause = clause;
         return false; // conflict
     }
 
-    if(truth_value == new_value){
+    if(old_value == new_value){
         return true; // already labeled with the same value
     }
 
-    auto old_value = truth_value;
-    auto old_change = last_change;
-    last_change = TruthValueChange(truth_value, level, reason);
-    truth_value = new_value;
+    trail_index[node] = trail.size();
+    trail.push_back(TruthValueChange(node, old_value, decision_level(), reason, clause));
+    dag.values[node] = new_value;
+    return true;
+}
+
+bool Propagator::propagate() {
+    // the trail doubles as the propagation queue: a node is labeled at most once
+    // until it is undone, so every entry past head is processed exactly once
+    while(head < trail.size()){
+        NodeId node = trail[head++].node;
+
+        // one pass per dequeued node: top-down rules of the node itself,
+        // bottom-up rules of every parent, the learned clauses watching it,
+        // then the XOR rows that read it
+        auto value = dag.values[node];
+        if(!true_count.empty()){
+            count_label(node, value, 1);
+        }
+        if(!propagate_children(node, value)){
+            return false;
+        }
+        if(!propagate_parents(node, value)){
+            return false;
+        }
+        if(!propagate_clauses(node)){
+            return false;
+        }
+        if(xors && !xors->propagate(*this, node)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Propagator::is_false(const NodeLiteral& lit) const {
+    auto value = dag.values[lit.node];
+    return value != TruthValue::UNKNOWN && value != lit.value;
+}
 
-    bool can_propagate_children = this->propagate_children(new_value, level);
-    if(!can_propagate_children){
-        truth_value = old_value;
-        last_change = old_change;
-        return false; // conflict during propagation to children
+bool Propagator::propagate_clauses(NodeId node) {
+    auto& ws = watches[node];
+    size_t i = 0, j = 0;
+    bool ok = true;
+    while(i < ws.size()){
+        int ci = ws[i++];
+        auto& c = clauses[ci];
+        // keep the literal of this node in the second watch
+        if(c[0].node == node){
+            std::swap(c[0], c[1]);
+        }
+        if(!is_false(c[1]) || dag.values[c[0].node] == c[0].value){
+            ws[j++] = ci;
+            continue;
+        }
+
+        // look for another literal that is not false to watch instead
+        bool moved = false;
+        for(size_t k = 2; k < c.size(); k++){
+            if(!is_false(c[k])){
+                std::swap(c[1], c[k]);
+                watches[c[1].node].push_back(ci);
+                moved = true;
+                break;
+            }
+        }
+        if(moved){
+            continue;
+        }
+
+        // every literal but the first is false: the first one is implied
+        ws[j++] = ci;
+        if(!assign(c[0].node, c[0].value, NO_NODE, ci)){
+            ok = false;
+            break;
+        }
     }
-    bool can_propagate_parents = this->propagate_parents(new_value, level);
-    if(!can_propagate_parents){
-        truth_value = old_value;
-        last_change = old_change;
-        return false; // conflict during propagation to parents
+    while(i < ws.size()){
+        ws[j++] = ws[i++];
     }
+    ws.resize(j);
+    return ok;
+}
 
-    return true; // we successfully labeled this node with new_value
-}
\ No newline at end of file
+int Propagator::add_clause(const std::vector<NodeLiteral>& clause) {
+    int ci = clauses.size();
+    clauses.push_back(clause);
+    if(clause.size() < 2){
+        return ci; // a unit clause is asserted at level 0 and never needs watching
+    }
+    watches[clause[0].node].push_back(ci);
+    watches[clause[1].node].push_back(ci);
+    return ci;
+}
+
+void Propagator::explain(NodeId node, TruthValue value, NodeId reason, int clause, size_t limit, std::vector<NodeId>& out) const {
+    if(clause >= 0){
+        for(auto& lit: clauses[clause]){
+            if(lit.node != node){
+                out.push_back(lit.node);
+            }
+        }
+    } else if(clause <= XOR_REASON){
+        xors->explain(XOR_REASON - clause, out);
+    } else if(reason != NO_NODE){
+        explain_rule(reason, node, value, limit, out);
+    }
+}
+
+void Propagator::new_decision_level() {
+    trail_lim.push_back(trail.size());
+}
+
+void Propagator::undo_to(size_t trail_size) {
+    while(trail.size() > trail_size){
+        auto& change = trail.back();
+        if(!true_count.empty() && trail.size() <= head){
+            count_label(change.node, dag.values[change.node], -1);
+        }
+        dag.values[change.node] = change.old_value;
+        trail.pop_back();
+    }
+    if(head > trail.size()){
+        head = trail.size();
+    }
+    if(xors){
+        xors->undo_to(trail.size());
+    }
+}
+
+void Propagator::backtrack(int level) {
+    if(level >= decision_level()){
+        return;
+    }
+    undo_to(trail_lim[level]);
+    trail_lim.resize(level);
+}
@@ -2,38 +2,234 @@
 #define __DAG_FORMULA__
 #include "formula.hpp"
 #include <vector>
+#include <array>
+#include <cstdint>
 
-enum class DAGOp { VAR, NOT, AND, OR, IMPLIES, EQ };
-enum class TruthValue { TRUE, FALSE, UNKNOWN, DONTCARE };
-enum class TruthValueChangeReason { TRIGGER, CONFLICT};
+enum class DAGOp : uint8_t { VAR, NOT, AND, OR, IMPLIES, EQ, CONST, XOR, ITE, ATLEAST };
+enum class TruthValue : uint8_t { TRUE, FALSE, UNKNOWN, DONTCARE };
 
+// Nodes are addressed by their index in the DAG arrays.
+using NodeId = uint32_t;
+const NodeId NO_NODE = 0xffffffff;
+
+// finalizer of splitmix64: spreads every input bit over the whole 64-bit hash
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// A contiguous run of node ids, such as the children or the parents of a node.
+struct NodeRange {
+    const NodeId* first;
+    const NodeId* last;
+
+    const NodeId* begin() const { return first; }
+    const NodeId* end() const { return last; }
+    size_t size() const { return last - first; }
+    NodeId operator[](size_t i) const { return first[i]; }
+};
+
+// The DAG in structure-of-arrays form. Node n has op ops[n] and truth value
+// values[n]; its children are children[child_start[n]] .. children[child_start[n+1]-1]
+// and its parents are laid out the same way in parents (compressed sparse rows).
+// A variable node stores the id of its name in the symbol table, a constant
+// node its value (0 or 1) and an ATLEAST node its bound in the same field.
+// Structurally equal nodes are shared (hash-consing): a node is identified by its
+// op and the ids of its children, or by its variable, and looked up by a 64-bit
+// hash of that key in a flat open-addressing table.
+struct DAG {
+    std::vector<DAGOp> ops;
+    std::vector<TruthValue> values;
+    std::vector<uint32_t> child_start{0};
+    std::vector<NodeId> children;
+    std::vector<uint32_t> parent_start;
+    std::vector<NodeId> parents;
+    std::vector<uint32_t> symbol;   // symbol_table id of a variable node, bound of ATLEAST, unused for other gates
+    size_t complementary_gates = 0; // AND/OR gates built with both x and NOT x as children
+    size_t folded_gates = 0;        // gates that constant folding replaced by a constant or a child
+
+    size_t size() const { return ops.size(); }
+    NodeRange children_of(NodeId node) const {
+        return {children.data() + child_start[node], children.data() + child_start[node + 1]};
+    }
+    NodeRange parents_of(NodeId node) const {
+        return {parents.data() + parent_start[node], parents.data() + parent_start[node + 1]};
+    }
+    const std::string& var_name(NodeId node) const { return symbol_table.name(symbol[node]); }
+    bool const_value(NodeId node) const { return symbol[node] != 0; }
+    uint32_t bound(NodeId node) const { return symbol[node]; }
+
+    // return the node of the given variable or gate, creating it if needed
+    NodeId make_var(uint32_t var);
+    NodeId make_const(bool value);
+    NodeId make_node(DAGOp op, NodeId left, NodeId right = NO_NODE);
+    // the same for any number of children, which may be reordered in place;
+    // AND/OR children are also deduplicated (returning the child if only one
+    // is left). Constants are folded away: a gate with a constant child becomes
+    // a constant or a smaller gate, and AND/OR with both x and NOT x become
+    // FALSE/TRUE, so a constant node is only ever the root of a formula
+    NodeId make_node(DAGOp op, NodeId* kids, uint32_t count);
+    // ATLEAST(bound, kids), whose children are sorted in place; constant
+    // children are folded into the bound, and a bound of 0, 1, count or more
+    // than count gives TRUE, OR, AND or FALSE instead
+    NodeId make_atleast(uint32_t bound, NodeId* kids, uint32_t count);
+    // fill the parent arrays from the children arrays, must be called after
+    // the last node is added and before propagating
+    void link_parents();
+    // drop every node but keep the allocated arrays, so a DAG rebuilt per query
+    // stops allocating once it has seen its largest formula
+    void clear();
+    // bytes held by the node arrays and the hash-consing table
+    size_t memory_bytes() const;
+
+    void print(NodeId node) const;
+
+private:
+    struct Slot {
+        uint64_t hash;
+        NodeId id;
+    };
+    std::vector<Slot> table;  // size is a power of two
+
+    template<typename Equal>
+    NodeId lookup(uint64_t hash, Equal equal, size_t& slot);
+    NodeId add_node(DAGOp op, const NodeId* kids, uint32_t count, uint32_t sym, uint64_t hash, size_t slot);
+    // the shared gate with this op, children and symbol field, added if new
+    NodeId intern(DAGOp op, const NodeId* kids, uint32_t count, uint32_t sym);
+    // IMPLIES/EQ/XOR of a and b folded to a simpler node, NO_NODE if neither
+    // child is a constant and a != b
+    NodeId fold_binary(DAGOp op, NodeId a, NodeId b);
+    // ITE(c, t, e) folded to a simpler node when c is a constant, a branch is
+    // a constant or c, or both branches are equal, NO_NODE otherwise
+    NodeId fold_ite(NodeId c, NodeId t, NodeId e);
+    void grow();
+};
+
+// add the nodes of formula f to dag, link parents, and return the node of f
+NodeId build_dag(Formula *f, DAG& dag);
+
+// a label implied by Gaussian elimination records XOR_REASON - k as its clause,
+// where k indexes the reasons kept by the XorSystem
+const int XOR_REASON = -2;
+
+struct XorSystem;
+
+// One entry of the assignment trail: the node that was labeled, the value it had
+// before, the decision level, and what implied the label. Undoing an entry is O(1).
+// The reason is the DAG node whose labeling rule fired (the labeled node itself for
+// bottom-up rules, one of its parents for top-down rules) or a learned clause;
+// decisions and the root label have neither.
 struct TruthValueChange {
+    NodeId node;
     TruthValue old_value;
     int level;
-    TruthValueChangeReason reason;
+    NodeId reason;
+    int clause;   // index of the implying learned clause, -1 if none, XOR_REASON - k for reason k of the XorSystem
 
-    TruthValueChange(TruthValue old_val, int lvl, TruthValueChangeReason r)
-        : old_value(old_val), level(lvl), reason(r) {}
+    TruthValueChange(NodeId n, TruthValue old_val, int lvl, NodeId r, int c)
+        : node(n), old_value(old_val), level(lvl), reason(r), clause(c) {}
 };
 
-struct DAGNode {
-    DAGOp op;
-    std::string var;  // only used if op == VAR
-    std::vector<DAGNode*> parents;
-    std::vector<DAGNode*> children;
-    TruthValue truth_value;
-    TruthValueChange last_change;
-    DAGNode() : truth_value(TruthValue::UNKNOWN), last_change(TruthValue::UNKNOWN, 0, TruthValueChangeReason::TRIGGER) {}
-
-    // try to lable this node with new_value at the given level, 
-    // return true if successful, false if it leads to a conflict
-    bool label(TruthValue new_value, int level, TruthValueChangeReason reason);
-    bool propagate_children(TruthValue new_value, int level);
-    bool propagate_parents(TruthValue new_value, int level);
-
-    void print() const;
+// A node literal: true when node is labeled with value.
+struct NodeLiteral {
+    NodeId node;
+    TruthValue value;
 };
 
-DAGNode* build_dag(Formula *f, std::map<std::string, DAGNode*>& node_map, DAGNode* parent = nullptr);
+// Propagation engine driven by the assignment trail. A newly labeled node is
+// appended to the trail instead of being propagated recursively, so deep
+// implication chains never grow the call stack. Decision levels mark trail
+// positions, and backtracking undoes exactly the labels made above a level.
+// Besides the DAG labeling rules, learned clauses over node literals are
+// propagated with two watched literals. Labels are stored in dag.values.
+// AND and OR gates of any width use the same idea: each gate watches two children
+// that do not have its neutral value (TRUE for AND, FALSE for OR), so a child
+// taking the neutral value costs O(1) unless it was watched, and the "all
+// children neutral" and "last open child" rules fire when no replacement is left.
+// ATLEAST nodes count their children instead: a child's label is added to the
+// TRUE or FALSE counter of each ATLEAST parent when it is dequeued and removed
+// when it is undone, so every rule of the node is an O(1) test, and only the
+// label that leaves the node no slack scans its children.
+// Each dequeued label is also passed to the XorSystem, if there is one.
+struct Propagator {
+    DAG& dag;
+
+    std::vector<TruthValueChange> trail;  // every label, in labeling order
+    std::vector<size_t> trail_lim;        // trail size at the start of each decision level
+    size_t head = 0;                      // next trail entry to propagate
+    std::vector<uint32_t> trail_index;    // position of a node's label on the trail
+
+    std::vector<std::vector<NodeLiteral>> clauses;  // learned clauses, watched literals first
+    std::vector<std::vector<int>> watches;          // clauses watching a literal of a node
+
+    // the two watched children of each AND/OR gate, indexed by node id; a watch
+    // only has the neutral value when no other child is left to replace it, and
+    // like clause watches they survive backtracking unchanged
+    std::vector<std::array<NodeId, 2>> gate_watches;
+    std::vector<uint32_t> watch_cursor;   // child where the next replacement search starts
+
+    // TRUE and FALSE children of each ATLEAST node among the propagated labels
+    // (trail entries below head), empty when the DAG has no such node
+    std::vector<uint32_t> true_count;
+    std::vector<uint32_t> false_count;
+
+    // XOR/EQ clusters propagated by Gaussian elimination, owned by the solver;
+    // null when there are none or the solver does without
+    XorSystem* xors = nullptr;
+
+    // the label that failed in the last conflict: conflict_node could not be
+    // labeled conflict_value because it already has the opposite value
+    NodeId conflict_node = NO_NODE;
+    TruthValue conflict_value = TruthValue::UNKNOWN;
+    NodeId conflict_reason = NO_NODE;
+    int conflict_clause = -1;
+
+    // dag must be complete, with parents linked, before the propagator is created
+    explicit Propagator(DAG& dag);
+
+    int decision_level() const { return trail_lim.size(); }
+    int level(NodeId node) const { return trail[trail_index[node]].level; }
+
+    // label node with new_value at the current decision level and queue it for
+    // propagation, return false (recording the conflict) if the node already has
+    // the opposite value
+    bool assign(NodeId node, TruthValue new_value, NodeId reason, int clause = -1);
+    // process queued labels until the queue is empty, return false on conflict
+    bool propagate();
+
+    void new_decision_level();
+    // undo labels until only the first trail_size entries are left
+    void undo_to(size_t trail_size);
+    // undo every label made above the given decision level
+    void backtrack(int level);
+
+    // add a learned clause, watching its first two literals, and return its index
+    int add_clause(const std::vector<NodeLiteral>& clause);
+    // append to out the nodes whose labels implied node = value through reason/clause,
+    // only nodes labeled before trail position limit are considered
+    void explain(NodeId node, TruthValue value, NodeId reason, int clause, size_t limit, std::vector<NodeId>& out) const;
+
+private:
+    // apply the labeling rules for a node's new value, queueing the implied labels
+    bool propagate_children(NodeId node, TruthValue new_value);
+    bool propagate_parents(NodeId node, TruthValue new_value);
+    bool propagate_clauses(NodeId node);
+    // child of the AND/OR gate took the neutral value: move its watch, or apply
+    // the rules that need all but at most one child neutral
+    bool update_gate_watch(NodeId gate, NodeId child);
+    // gate has the absorbing value: if one watch is neutral, the other is implied
+    bool propagate_last_open_child(NodeId gate);
+    // add delta to the counters of the ATLEAST parents of a node with value
+    void count_label(NodeId node, TruthValue value, int delta);
+    // labeled ATLEAST gate without slack: label its open children alike
+    bool propagate_cardinality(NodeId gate);
+    // antecedents of a label implied by the rules of gate
+    void explain_rule(NodeId gate, NodeId implied, TruthValue value, size_t limit, std::vector<NodeId>& out) const;
+    bool is_false(const NodeLiteral& lit) const;
+};
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,251 @@
+#include "dagsolver.hpp"
+
+namespace {
+TruthValue opposite(TruthValue value) {
+    return value == TruthValue::TRUE ? TruthValue::FALSE : TruthValue::TRUE;
+}
+}
+
+DAGSolver::DAGSolver(DAG& dag, NodeId root, bool gauss) : dag(dag), root(root), propagator(dag) {
+    if(gauss){
+        xors.build(dag);
+        if(!xors.empty()){
+            propagator.xors = &xors;
+        }
+    }
+    var_index.assign(dag.size(), -1);
+    seen.assign(dag.size(), false);
+    for(NodeId node = 0; node < dag.size(); node++){
+        if(dag.ops[node] == DAGOp::VAR){
+            var_index[node] = vars.size();
+            vars.push_back(node);
+        }
+    }
+    activity.assign(vars.size(), 0);
+    phase.assign(vars.size(), TruthValue::FALSE);
+    heap_pos.assign(vars.size(), -1);
+    for(size_t v = 0; v < vars.size(); v++){
+        heap_insert(v);
+    }
+}
+
+void DAGSolver::heap_up(int i) {
+    int v = heap[i];
+    while(i > 0){
+        int parent = (i - 1) / 2;
+        if(activity[heap[parent]] >= activity[v]){
+            break;
+        }
+        heap[i] = heap[parent];
+        heap_pos[heap[i]] = i;
+        i = parent;
+    }
+    heap[i] = v;
+    heap_pos[v] = i;
+}
+
+void DAGSolver::heap_down(int i) {
+    int v = heap[i];
+    int n = heap.size();
+    while(2 * i + 1 < n){
+        int child = 2 * i + 1;
+        if(child + 1 < n && activity[heap[child + 1]] > activity[heap[child]]){
+            child++;
+        }
+        if(activity[heap[child]] <= activity[v]){
+            break;
+        }
+        heap[i] = heap[child];
+        heap_pos[heap[i]] = i;
+        i = child;
+    }
+    heap[i] = v;
+    heap_pos[v] = i;
+}
+
+void DAGSolver::heap_insert(int v) {
+    if(heap_pos[v] >= 0){
+        return;
+    }
+    heap.push_back(v);
+    heap_up(heap.size() - 1);
+}
+
+int DAGSolver::heap_pop() {
+    int top = heap[0];
+    heap_pos[top] = -1;
+    heap[0] = heap.back();
+    heap.pop_back();
+    if(!heap.empty()){
+        heap_pos[heap[0]] = 0;
+        heap_down(0);
+    }
+    return top;
+}
+
+void DAGSolver::bump(NodeId node) {
+    int v = var_index[node];
+    if(v < 0){
+        return;
+    }
+    activity[v] += var_inc;
+    if(activity[v] > 1e100){
+        for(auto& a: activity){
+            a *= 1e-100;
+        }
+        var_inc *= 1e-100;
+    }
+    if(heap_pos[v] >= 0){
+        heap_up(heap_pos[v]);
+    }
+}
+
+NodeId DAGSolver::pick_branch_var() {
+    while(!heap.empty()){
+        int v = heap_pop();
+        if(dag.values[vars[v]] == TruthValue::UNKNOWN){
+            return vars[v];
+        }
+    }
+    return NO_NODE;
+}
+
+void DAGSolver::backtrack(int level) {
+    // variables labeled above the level become unlabeled again: remember their
+    // values and put them back among the branching candidates
+    auto& trail = propagator.trail;
+    for(size_t i = propagator.trail_lim[level]; i < trail.size(); i++){
+        int v = var_index[trail[i].node];
+        if(v >= 0){
+            phase[v] = dag.values[trail[i].node];
+            heap_insert(v);
+        }
+    }
+    propagator.backtrack(level);
+}
+
+int DAGSolver::analyze(std::vector<NodeLiteral>& learned) {
+    auto& p = propagator;
+
+    // the conflicting node's label together with the labels that implied the opposite one
+    antecedents.clear();
+    antecedents.push_back(p.conflict_node);
+    p.explain(p.conflict_node, p.conflict_value, p.conflict_reason, p.conflict_clause, p.trail.size(), antecedents);
+
+    int conflict_level = 0;
+    for(auto node: antecedents){
+        conflict_level = std::max(conflict_level, p.level(node));
+    }
+    if(conflict_level == 0){
+        return -1;
+    }
+    if(conflict_level < p.decision_level()){
+        backtrack(conflict_level);
+    }
+
+    learned.clear();
+    learned.push_back({NO_NODE, TruthValue::UNKNOWN});  // the asserting literal goes here
+    std::vector<NodeId> marked;
+    int open = 0;               // marked nodes of the conflict level not yet resolved
+    size_t index = p.trail.size();
+    while(true){
+        for(auto node: antecedents){
+            int lvl = p.level(node);
+            if(seen[node] || lvl == 0){
+                continue;
+            }
+            seen[node] = true;
+            marked.push_back(node);
+            bump(node);
+            if(lvl == conflict_level){
+                open++;
+            } else {
+                learned.push_back({node, opposite(dag.values[node])});
+            }
+        }
+
+        // resolve the most recent marked label of the conflict level
+        do {
+            index--;
+        } while(!seen[p.trail[index].node]);
+        auto& change = p.trail[index];
+        if(--open == 0){
+            learned[0] = {change.node, opposite(dag.values[change.node])};
+            break;
+        }
+        antecedents.clear();
+        p.explain(change.node, dag.values[change.node], change.reason, change.clause, index, antecedents);
+    }
+    for(auto node: marked){
+        seen[node] = false;
+    }
+
+    // backjump to the highest level among the other literals, which is watched second
+    int backjump_level = 0;
+    for(size_t i = 1; i < learned.size(); i++){
+        int lvl = p.level(learned[i].node);
+        if(lvl > backjump_level){
+            backjump_level = lvl;
+            std::swap(learned[1], learned[i]);
+        }
+    }
+    return backjump_level;
+}
+
+bool DAGSolver::solve() {
+    // a level-0 conflict leaves its labels on the trail, so the search cannot
+    // start over from them
+    if(unsat){
+        return false;
+    }
+    if(propagator.decision_level() > 0){
+        backtrack(0);
+    }
+    // constants fold into their parents, so one can only be the root of a
+    // formula that folded entirely, and every valuation is a model of TRUE
+    if(dag.ops[root] == DAGOp::CONST){
+        return dag.const_value(root);
+    }
+    if(!propagator.assign(root, TruthValue::TRUE, NO_NODE)){
+        unsat = true;
+        return false;
+    }
+    if(propagator.xors && !xors.propagate_fixed(propagator)){
+        unsat = true;
+        return false;
+    }
+
+    std::vector<NodeLiteral> learned;
+    while(true){
+        if(!propagator.propagate()){
+            conflicts++;
+            int backjump_level = analyze(learned);
+            if(backjump_level < 0){
+                unsat = true;
+                return false;
+            }
+            backtrack(backjump_level);
+            int ci = propagator.add_clause(learned);
+            propagator.assign(learned[0].node, learned[0].value, NO_NODE, ci);
+            var_inc /= 0.95;
+            continue;
+        }
+
+        NodeId var = pick_branch_var();
+        if(var == NO_NODE){
+            return true; // every variable is labeled without conflict
+        }
+
+        decisions++;
+        propagator.new_decision_level();
+        propagator.assign(var, phase[var_index[var]], NO_NODE);
+    }
+}
+
+Valuation DAGSolver::model() const {
+    Valuation v(symbol_table.size());
+    for(auto var: vars){
+        v.set(dag.symbol[var], dag.values[var] == TruthValue::TRUE);
+    }
+    return v;
+}
@@ -0,0 +1,58 @@
+#ifndef __DAG_SOLVER__
+#define __DAG_SOLVER__
+#include "dagformula.hpp"
+#include "gauss.hpp"
+
+// Conflict-driven search over the DAG. The solver decides unassigned variable
+// nodes and propagates; on conflict it walks the implication graph recorded on the
+// trail (every label knows the node rule or learned clause that implied it),
+// learns a clause over node literals at the first unique implication point, and
+// backjumps non-chronologically to the level where that clause becomes unit.
+// Gates are never decided on: once every variable node is labeled without
+// conflict, bottom-up propagation has evaluated all gates, so the variable labels
+// form a model of the formula.
+struct DAGSolver {
+    DAG& dag;
+    NodeId root;
+    std::vector<NodeId> vars;     // variable nodes
+    Propagator propagator;
+    XorSystem xors;               // XOR/EQ clusters, empty unless gauss is set
+
+    int decisions = 0;
+    int conflicts = 0;
+
+    // with gauss set, clusters of XOR and EQ nodes are also propagated by
+    // Gaussian elimination
+    DAGSolver(DAG& dag, NodeId root, bool gauss = true);
+
+    // search for a labeling with the root TRUE, return true if one exists
+    bool solve();
+    // values of the variables after a successful solve()
+    Valuation model() const;
+
+private:
+    std::vector<int> var_index;       // position in vars, indexed by node id (-1 for gates)
+    std::vector<double> activity;     // VSIDS score of each variable
+    double var_inc = 1;
+    bool unsat = false;               // a conflict at level 0 was found, solve() stays false
+    std::vector<TruthValue> phase;    // last value of each variable, tried first
+    std::vector<int> heap;            // unlabeled variables ordered by activity
+    std::vector<int> heap_pos;        // position of a variable in heap, -1 if absent
+
+    std::vector<bool> seen;           // scratch for analyze, indexed by node id
+    std::vector<NodeId> antecedents;
+
+    // derive a learned clause from the last conflict, asserting literal first,
+    // and return the level to backjump to (-1 if the formula is unsatisfiable)
+    int analyze(std::vector<NodeLiteral>& learned);
+    NodeId pick_branch_var();
+    void backtrack(int level);
+    void bump(NodeId node);
+
+    void heap_insert(int v);
+    int heap_pop();
+    void heap_up(int i);
+    void heap_down(int i);
+};
+
+#endif
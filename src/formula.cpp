@@ -1,149 +1,129 @@
 #include "formula.hpp"
-#include <iterator>
+#include "arena.hpp"
 
-void Variable::print() const {
-    std::cout << name;
-}
-
-bool Variable::solve(const Valuation& valuation) const {
-    auto it = valuation.find(name);
-    return it != valuation.end() ? it->second : false;
-}
-
-std::set<std::string> Variable::get_vars() const {
-    return {name};
-}
-
-Not::Not(Formula* op) : operand(op) {}
-
-Not::~Not() {
-    delete operand;
-}
-
-void Not::print() const {
-    std::cout << "¬";
-    operand->print();
-}
-
-bool Not::solve(const Valuation& valuation) const {
-    return !operand->solve(valuation);
-}
-
-std::set<std::string> Not::get_vars() const {
-    return operand->get_vars();
-}
-
-BinaryOp::BinaryOp(Formula* l, Formula* r, char) : left(l), right(r) {}
-
-BinaryOp::~BinaryOp() {
-    delete left;
-    delete right;
-}
-
-std::set<std::string> BinaryOp::get_vars() const {
-    auto left_vars = left->get_vars();
-    auto right_vars = right->get_vars();
-    std::set<std::string> res;
-    std::set_union(
-        left_vars.begin(), left_vars.end(),
-        right_vars.begin(), right_vars.end(),
-        std::inserter(res, res.begin()));
-    return res;
-}
-
-And::And(Formula* l, Formula* r) : BinaryOp(l, r, '&') {}
-
-void And::print() const {
-    std::cout << "(";
-    left->print();
-    std::cout << " ∧ ";
-    right->print();
-    std::cout << ")";
-}
-
-bool And::solve(const Valuation& valuation) const {
-    return left->solve(valuation) && right->solve(valuation);
-}
-
-std::string And::signature() const {
-    auto left_sig = left->signature();
-    auto right_sig = right->signature();
+SymbolTable symbol_table;
 
-    //in order to have a unique signature for logically equivalent formulas, 
-    //we sort the signatures of the left and right subformulas
-    if(left_sig < right_sig){
-        return "AND(" + left_sig + "," + right_sig + ")";
+uint32_t SymbolTable::intern(const std::string& name) {
+    auto it = ids.find(name);
+    if(it != ids.end()){
+        return it->second;
     }
-    return "AND(" + right_sig + "," + left_sig + ")";
-}
-
-Or::Or(Formula* l, Formula* r) : BinaryOp(l, r, '|') {}
-
-void Or::print() const {
-    std::cout << "(";
-    left->print();
-    std::cout << " ∨ ";
-    right->print();
-    std::cout << ")";
-}
-
-bool Or::solve(const Valuation& valuation) const {
-    return left->solve(valuation) || right->solve(valuation);
-}
-
-std::string Or::signature() const {
-    auto left_sig = left->signature();
-    auto right_sig = right->signature();
-
-    //in order to have a unique signature for logically equivalent formulas, 
-    //we sort the signatures of the left and right subformulas
-    if(left_sig < right_sig){
-        return "OR(" + left_sig + "," + right_sig + ")";
+    uint32_t id = names.size();
+    names.push_back(name);
+    ids.emplace(name, id);
+    return id;
+}
+
+namespace {
+const char* const BINARY_SYMBOLS[] = {"", "", " ∧ ", " ∨ ", " => ", " <=> ", "", " ⊕ ", "", ", "};
+const char* const SIGNATURE_NAMES[] = {"", "NOT", "AND", "OR", "IMP", "EQ", "", "XOR", "ITE", "ATLEAST"};
+
+const char* constant_name(const Formula* node) {
+    return static_cast<const Constant*>(node)->value ? "true" : "false";
+}
+}
+
+AtLeast* make_at_least(Arena& arena, uint32_t bound, Formula* const* operands, uint32_t count) {
+    auto copy = static_cast<Formula**>(arena.allocate(count * sizeof(Formula*), alignof(Formula*)));
+    std::copy(operands, operands + count, copy);
+    return arena.make<AtLeast>(bound, copy, count);
+}
+
+void Formula::print() const {
+    walk(this,
+        [](const Formula* node){
+            switch(node->op){
+                case FormulaOp::VAR: std::cout << static_cast<const Variable*>(node)->name(); break;
+                case FormulaOp::NOT: std::cout << "¬"; break;
+                case FormulaOp::CONST: std::cout << constant_name(node); break;
+                case FormulaOp::ATLEAST: std::cout << "atleast(" << static_cast<const AtLeast*>(node)->bound << ", "; break;
+                default: std::cout << "("; break;
+            }
+        },
+        [](const Formula* node, size_t i){
+            if(node->op == FormulaOp::ITE){
+                std::cout << (i == 1 ? " ? " : " : ");
+            }
+            else{
+                std::cout << BINARY_SYMBOLS[(int)node->op];
+            }
+        },
+        [](const Formula* node){
+            if(node->arity() >= 2 || node->op == FormulaOp::ATLEAST){
+                std::cout << ")";
+            }
+        });
+}
+
+bool Formula::solve(const Valuation& valuation) const {
+    return fold<char>(this, [&](const Formula* node, const char* operands) -> char {
+        switch(node->op){
+            case FormulaOp::VAR: return valuation.get(static_cast<const Variable*>(node)->id);
+            case FormulaOp::NOT: return !operands[0];
+            case FormulaOp::AND: return operands[0] && operands[1];
+            case FormulaOp::OR: return operands[0] || operands[1];
+            case FormulaOp::IMPLIES: return !operands[0] || operands[1];
+            case FormulaOp::EQ: return operands[0] == operands[1];
+            case FormulaOp::CONST: return static_cast<const Constant*>(node)->value;
+            case FormulaOp::XOR: return operands[0] != operands[1];
+            case FormulaOp::ITE: return operands[0] ? operands[1] : operands[2];
+            case FormulaOp::ATLEAST: {
+                auto n = static_cast<const AtLeast*>(node)->count;
+                return std::count(operands, operands + n, 1) >= static_cast<const AtLeast*>(node)->bound;
+            }
+        }
+        return false;
+    });
+}
+
+std::vector<uint32_t> Formula::get_vars() const {
+    std::vector<char> seen(symbol_table.size(), 0);
+    walk(this,
+        [&](const Formula* node){
+            if(node->op == FormulaOp::VAR){
+                seen[static_cast<const Variable*>(node)->id] = 1;
+            }
+        },
+        [](const Formula*, size_t){},
+        [](const Formula*){});
+    std::vector<uint32_t> vars;
+    for(uint32_t id = 0; id < seen.size(); id++){
+        if(seen[id]){
+            vars.push_back(id);
+        }
     }
-    return "OR(" + right_sig + "," + left_sig + ")";
-}
-
-Implies::Implies(Formula* l, Formula* r) : BinaryOp(l, r, '>') {}
-
-void Implies::print() const {
-    std::cout << "(";
-    left->print();
-    std::cout << " => ";
-    right->print();
-    std::cout << ")";
-}
-
-bool Implies::solve(const Valuation& valuation) const {
-    return !left->solve(valuation) || right->solve(valuation);
+    return vars;
+}
+
+std::string Formula::signature() const {
+    return fold<std::string>(this, [](const Formula* node, std::string* operands) -> std::string {
+        std::string name = SIGNATURE_NAMES[(int)node->op];
+        switch(node->op){
+            case FormulaOp::VAR:
+                return static_cast<const Variable*>(node)->name();
+            case FormulaOp::CONST:
+                return constant_name(node);
+            case FormulaOp::NOT:
+            case FormulaOp::IMPLIES:
+            case FormulaOp::ITE:
+                break;
+            case FormulaOp::ATLEAST:
+                // the bound is part of the name, and the operands are unordered
+                name += std::to_string(static_cast<const AtLeast*>(node)->bound);
+                std::sort(operands, operands + node->arity());
+                break;
+            default:
+                //in order to have a unique signature for logically equivalent formulas,
+                //we sort the signatures of the left and right subformulas
+                if(operands[1] < operands[0]){
+                    std::swap(operands[0], operands[1]);
+                }
+                break;
+        }
+        std::string sig = name + "(";
+        for(size_t i = 0; i < node->arity(); i++){
+            sig += (i == 0 ? "" : ",") + operands[i];
+        }
+        return sig + ")";
+    });
 }
-
-std::string Implies::signature() const {
-    return "IMP(" + left->signature() + "," + right->signature() + ")";
-}
-
-Eq::Eq(Formula* l, Formula* r) : BinaryOp(l, r, '=') {}
-
-void Eq::print() const {
-    std::cout << "(";
-    left->print();
-    std::cout << " <=> ";
-    right->print();
-    std::cout << ")";
-}
-
-bool Eq::solve(const Valuation& valuation) const {
-    return left->solve(valuation) == right->solve(valuation);
-}
-
-std::string Eq::signature() const {
-    auto left_sig = left->signature();
-    auto right_sig = right->signature();
-
-    //in order to have a unique signature for logically equivalent formulas, 
-    //we sort the signatures of the left and right subformulas
-    if(left_sig < right_sig){
-        return "EQ(" + left_sig + "," + right_sig + ")";
-    }
-    return "EQ(" + right_sig + "," + left_sig + ")";
-}
-
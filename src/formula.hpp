@@ -4,84 +4,221 @@
 #include <map>
 #include <string>
 #include <iostream>
-#include <set>
 #include <algorithm>
+#include <vector>
+#include <cstdint>
+
+// Interns variable names to dense ids 0, 1, 2, ... in order of first use.
+struct SymbolTable {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint32_t> ids;
+
+    // return the id of name, adding it if it is new
+    uint32_t intern(const std::string& name);
+    const std::string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+};
+
+// shared by the parser and every Variable, so equal names get equal ids
+extern SymbolTable symbol_table;
+
+// Truth values of variables indexed by their id, one bit per variable.
+// Variables that were never set are false.
+struct Valuation {
+    std::vector<uint64_t> bits;
 
-using Valuation = std::map<std::string, bool>;
+    explicit Valuation(size_t count = 0) : bits((count + 63) / 64, 0) {}
 
+    bool get(uint32_t id) const {
+        size_t word = id >> 6;
+        return word < bits.size() && (bits[word] >> (id & 63) & 1);
+    }
+    void set(uint32_t id, bool value) {
+        size_t word = id >> 6;
+        if(word >= bits.size()){
+            bits.resize(word + 1, 0);
+        }
+        uint64_t mask = uint64_t(1) << (id & 63);
+        bits[word] = value ? bits[word] | mask : bits[word] & ~mask;
+    }
+};
+
+enum class FormulaOp : uint8_t { VAR, NOT, AND, OR, IMPLIES, EQ, CONST, XOR, ITE, ATLEAST };
+
+// Formula nodes do not own their subformulas: trees are allocated in an Arena
+// and released all at once with it, never deleted node by node.
+// Every node carries the op tag of its type, and code that depends on the type
+// switches on the tag (or calls visit() below) instead of testing casts; nodes
+// have no virtual members. The whole-formula operations walk the tree with an
+// explicit stack (see walk() and fold() below), so the depth of a formula is
+// bounded by memory rather than by the thread stack.
 struct Formula {
-    virtual ~Formula() = default;
-    virtual void print() const = 0;
-    virtual bool solve(const Valuation& valuation) const = 0;
-    virtual std::set<std::string> get_vars() const = 0;
-    virtual std::string signature() const = 0;
+    const FormulaOp op;
+
+    void print() const;
+    bool solve(const Valuation& valuation) const;
+    // ids of the variables of the formula in increasing order, in one pass
+    std::vector<uint32_t> get_vars() const;
+    std::string signature() const;
+
+    size_t arity() const;
+    Formula* child(size_t i) const;
+
+protected:
+    explicit Formula(FormulaOp op) : op(op) {}
+    ~Formula() = default;
 };
 
 struct Variable : Formula {
-    std::string name;
-    Variable(const std::string& n) : name(n) {}
-    void print() const override;
-    bool solve(const Valuation& valuation) const override;
-    std::set<std::string> get_vars() const override;
-    std::string signature() const override {
-        return name;
-    }
+    uint32_t id;    // index into symbol_table
+    Variable(const std::string& n) : Formula(FormulaOp::VAR), id(symbol_table.intern(n)) {}
+    const std::string& name() const { return symbol_table.name(id); }
+};
+
+struct Constant : Formula {
+    bool value;
+    explicit Constant(bool v) : Formula(FormulaOp::CONST), value(v) {}
 };
 
 struct Not : Formula {
     Formula* operand;
 
-    explicit Not(Formula* op);
-    ~Not() override;
-
-    void print() const override;
-    bool solve(const Valuation& valuation) const override;
-    std::set<std::string> get_vars() const override;
-    std::string signature() const override {
-        return "NOT(" + operand->signature() + ")";
-    }
+    explicit Not(Formula* o) : Formula(FormulaOp::NOT), operand(o) {}
 };
 
 struct BinaryOp : Formula {
     Formula* left;
     Formula* right;
 
-    BinaryOp(Formula* l, Formula* r, char o);
-    ~BinaryOp() override;
-
-    std::set<std::string> get_vars() const override;
+protected:
+    BinaryOp(Formula* l, Formula* r, FormulaOp op) : Formula(op), left(l), right(r) {}
 };
 
 struct And : BinaryOp {
-    And(Formula* l, Formula* r);
-
-    void print() const override;
-    bool solve(const Valuation& valuation) const override;
-    std::string signature() const override;
+    And(Formula* l, Formula* r) : BinaryOp(l, r, FormulaOp::AND) {}
 };
 
 struct Or : BinaryOp {
-    Or(Formula* l, Formula* r);
-
-    void print() const override;
-    bool solve(const Valuation& valuation) const override;
-    std::string signature() const override;
+    Or(Formula* l, Formula* r) : BinaryOp(l, r, FormulaOp::OR) {}
 };
 
 struct Implies : BinaryOp {
-    Implies(Formula* l, Formula* r);
-
-    void print() const override;
-    bool solve(const Valuation& valuation) const override;
-    std::string signature() const override;
+    Implies(Formula* l, Formula* r) : BinaryOp(l, r, FormulaOp::IMPLIES) {}
 };
 
 struct Eq : BinaryOp {
-    Eq(Formula* l, Formula* r);
+    Eq(Formula* l, Formula* r) : BinaryOp(l, r, FormulaOp::EQ) {}
+};
 
-    void print() const override;
-    bool solve(const Valuation& valuation) const override;
-    std::string signature() const override;
+struct Xor : BinaryOp {
+    Xor(Formula* l, Formula* r) : BinaryOp(l, r, FormulaOp::XOR) {}
 };
 
-#endif
\ No newline at end of file
+// if-then-else: then_branch where condition holds, else_branch elsewhere
+struct Ite : Formula {
+    Formula* condition;
+    Formula* then_branch;
+    Formula* else_branch;
+
+    Ite(Formula* c, Formula* t, Formula* e) : Formula(FormulaOp::ITE), condition(c), then_branch(t), else_branch(e) {}
+};
+
+// cardinality: at least bound of the operands hold; at most k is written as
+// NOT AtLeast(k + 1)
+struct AtLeast : Formula {
+    uint32_t bound;
+    uint32_t count;
+    Formula** operands;     // count subformulas, in the arena of the node
+
+    AtLeast(uint32_t b, Formula** o, uint32_t n) : Formula(FormulaOp::ATLEAST), bound(b), count(n), operands(o) {}
+};
+
+class Arena;
+// an AtLeast node over a copy of operands[0 .. count-1], allocated in arena
+AtLeast* make_at_least(Arena& arena, uint32_t bound, Formula* const* operands, uint32_t count);
+
+inline size_t Formula::arity() const {
+    switch(op){
+        case FormulaOp::VAR:
+        case FormulaOp::CONST: return 0;
+        case FormulaOp::NOT: return 1;
+        case FormulaOp::ITE: return 3;
+        case FormulaOp::ATLEAST: return static_cast<const AtLeast*>(this)->count;
+        default: return 2;
+    }
+}
+
+inline Formula* Formula::child(size_t i) const {
+    if(op == FormulaOp::NOT){
+        return static_cast<const Not*>(this)->operand;
+    }
+    if(op == FormulaOp::ITE){
+        auto ite = static_cast<const Ite*>(this);
+        return i == 0 ? ite->condition : i == 1 ? ite->then_branch : ite->else_branch;
+    }
+    if(op == FormulaOp::ATLEAST){
+        return static_cast<const AtLeast*>(this)->operands[i];
+    }
+    auto binary = static_cast<const BinaryOp*>(this);
+    return i == 0 ? binary->left : binary->right;
+}
+
+// Call the overload of visitor for the type of f, chosen by one switch on its
+// tag. All overloads must return the same type.
+template<typename Visitor>
+decltype(auto) visit(const Formula* f, Visitor&& visitor) {
+    switch(f->op){
+        case FormulaOp::VAR: return visitor(static_cast<const Variable*>(f));
+        case FormulaOp::NOT: return visitor(static_cast<const Not*>(f));
+        case FormulaOp::AND: return visitor(static_cast<const And*>(f));
+        case FormulaOp::OR: return visitor(static_cast<const Or*>(f));
+        case FormulaOp::IMPLIES: return visitor(static_cast<const Implies*>(f));
+        case FormulaOp::CONST: return visitor(static_cast<const Constant*>(f));
+        case FormulaOp::XOR: return visitor(static_cast<const Xor*>(f));
+        case FormulaOp::ITE: return visitor(static_cast<const Ite*>(f));
+        case FormulaOp::ATLEAST: return visitor(static_cast<const AtLeast*>(f));
+        case FormulaOp::EQ: break;
+    }
+    return visitor(static_cast<const Eq*>(f));
+}
+
+// Depth-first walk of f with an explicit stack: enter(node) is called before
+// the children of node, between(node, i) before its child i > 0, and
+// leave(node) after its last child.
+template<typename Enter, typename Between, typename Leave>
+void walk(const Formula* f, Enter enter, Between between, Leave leave) {
+    std::vector<std::pair<const Formula*, size_t>> stack;
+    enter(f);
+    stack.push_back({f, 0});
+    while(!stack.empty()){
+        auto node = stack.back().first;
+        size_t i = stack.back().second++;
+        if(i == node->arity()){
+            leave(node);
+            stack.pop_back();
+            continue;
+        }
+        if(i > 0){
+            between(node, i);
+        }
+        auto child = node->child(i);
+        enter(child);
+        stack.push_back({child, 0});
+    }
+}
+
+// Post-order evaluation of f: combine(node, operands) gets the results for the
+// children of node in operands[0 .. arity-1] and returns the result for node.
+template<typename T, typename Combine>
+T fold(const Formula* f, Combine combine) {
+    std::vector<T> values;
+    walk(f, [](const Formula*){}, [](const Formula*, size_t){}, [&](const Formula* node){
+        size_t first = values.size() - node->arity();
+        T result = combine(node, values.data() + first);
+        values.resize(first);
+        values.push_back(std::move(result));
+    });
+    return std::move(values.back());
+}
+
+#endif
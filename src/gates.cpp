@@ -0,0 +1,551 @@
+#include "gates.hpp"
+#include "block.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+namespace {
+// a block holds one bit per valuation, and the inputs below BLOCK_INPUTS are
+// given by the position of a bit inside it
+const unsigned BLOCK_INPUTS = 6 + LANE_BITS;
+
+// bit t of a word is valuation t, so input i < 6 is bit i of t
+const uint64_t WORD_PATTERNS[6] = {
+    0xaaaaaaaaaaaaaaaaULL, 0xccccccccccccccccULL, 0xf0f0f0f0f0f0f0f0ULL,
+    0xff00ff00ff00ff00ULL, 0xffff0000ffff0000ULL, 0xffffffff00000000ULL
+};
+
+Block broadcast(uint64_t word) {
+    Block block = {};
+    for(unsigned lane = 0; lane < LANES; lane++){
+        block[lane] = word;
+    }
+    return block;
+}
+
+// input 6 + j is bit j of the lane number
+Block lane_pattern(unsigned j) {
+    Block block = {};
+    for(unsigned lane = 0; lane < LANES; lane++){
+        block[lane] = lane >> j & 1 ? ~0ULL : 0;
+    }
+    return block;
+}
+
+bool evaluate_gate(GateOp op, bool a, bool b) {
+    switch(op){
+        case GateOp::AND: return a && b;
+        case GateOp::OR: return a || b;
+        case GateOp::IMPLIES: return !a || b;
+        case GateOp::EQ: return a == b;
+        case GateOp::NOT: return !a;
+        case GateOp::TRUE: return true;
+        case GateOp::XOR: return a != b;
+    }
+    return false;
+}
+
+GateOp gate_op(DAGOp op) {
+    switch(op){
+        case DAGOp::AND: return GateOp::AND;
+        case DAGOp::OR: return GateOp::OR;
+        case DAGOp::IMPLIES: return GateOp::IMPLIES;
+        case DAGOp::EQ: return GateOp::EQ;
+        case DAGOp::XOR: return GateOp::XOR;
+        default: return GateOp::NOT;
+    }
+}
+}
+
+GateList compile_gates(const DAG& dag, NodeId root) {
+    // children are always created before their parents, so node ids are
+    // already a topological order; mark the cone of root walking downwards
+    std::vector<char> in_cone(root + 1, 0);
+    in_cone[root] = 1;
+    for(NodeId n = root + 1; n-- > 0;){
+        if(in_cone[n]){
+            for(auto child: dag.children_of(n)){
+                in_cone[child] = 1;
+            }
+        }
+    }
+
+    // inputs in increasing symbol id, so that they double as the sorted
+    // variable support of the formula
+    std::vector<NodeId> vars;
+    for(NodeId n = 0; n <= root; n++){
+        if(in_cone[n] && dag.ops[n] == DAGOp::VAR){
+            vars.push_back(n);
+        }
+    }
+    std::sort(vars.begin(), vars.end(), [&](NodeId x, NodeId y){
+        return dag.symbol[x] < dag.symbol[y];
+    });
+    GateList list;
+    std::vector<uint32_t> slot(root + 1, 0);
+    for(auto n: vars){
+        slot[n] = list.inputs.size();
+        list.inputs.push_back(dag.symbol[n]);
+    }
+
+    uint32_t next = list.inputs.size();
+    std::vector<uint32_t> count;
+    for(NodeId n = 0; n <= root; n++){
+        if(!in_cone[n] || dag.ops[n] == DAGOp::VAR){
+            continue;
+        }
+        if(dag.ops[n] == DAGOp::CONST){
+            list.gates.push_back({GateOp::TRUE, 0, 0});
+            slot[n] = next++;
+            if(!dag.const_value(n)){
+                list.gates.push_back({GateOp::NOT, slot[n], slot[n]});
+                slot[n] = next++;
+            }
+            continue;
+        }
+        auto kids = dag.children_of(n);
+        if(dag.ops[n] == DAGOp::ITE){
+            list.gates.push_back({GateOp::IMPLIES, slot[kids[0]], slot[kids[1]]});
+            list.gates.push_back({GateOp::OR, slot[kids[0]], slot[kids[2]]});
+            list.gates.push_back({GateOp::AND, next, next + 1});
+            slot[n] = next + 2;
+            next += 3;
+            continue;
+        }
+        if(dag.ops[n] == DAGOp::ATLEAST){
+            // after each child, count[j] is the slot of "at least j + 1 of the
+            // children so far"; counts at or above the bound are never needed
+            uint32_t bound = dag.bound(n);
+            count.clear();
+            for(auto kid: kids){
+                for(size_t j = std::min<size_t>(count.size() + 1, bound); j-- > 0;){
+                    uint32_t carry = slot[kid];
+                    if(j > 0){
+                        list.gates.push_back({GateOp::AND, count[j - 1], carry});
+                        carry = next++;
+                    }
+                    if(j == count.size()){
+                        count.push_back(carry);
+                    } else {
+                        list.gates.push_back({GateOp::OR, count[j], carry});
+                        count[j] = next++;
+                    }
+                }
+            }
+            slot[n] = count[bound - 1];
+            continue;
+        }
+        auto op = gate_op(dag.ops[n]);
+        uint32_t acc = slot[kids[0]];
+        if(dag.ops[n] == DAGOp::NOT){
+            list.gates.push_back({op, acc, acc});
+            acc = next++;
+        }
+        for(size_t i = 1; i < kids.size(); i++){
+            list.gates.push_back({op, acc, slot[kids[i]]});
+            acc = next++;
+        }
+        slot[n] = acc;
+    }
+    list.output = slot[root];
+    return list;
+}
+
+GateList compile_gates(Formula* f) {
+    DAG dag;
+    auto root = build_dag(f, dag);
+    return compile_gates(dag, root);
+}
+
+GateList compile_gates(const AIG& aig, AigLit root) {
+    GateList list;
+    uint32_t top = aig_node(root);
+    if(top == 0){
+        list.gates.push_back({GateOp::TRUE, 0, 0});
+        if(root == AIG_FALSE){
+            list.gates.push_back({GateOp::NOT, 0, 0});
+        }
+        list.output = list.slots() - 1;
+        return list;
+    }
+
+    // fanins come before their readers, so mark the cone walking downwards,
+    // noting which nodes are read complemented
+    const uint8_t READ = 1, READ_COMPLEMENTED = 2;
+    std::vector<uint8_t> mark(top + 1, 0);
+    mark[top] = aig_complemented(root) ? READ_COMPLEMENTED : READ;
+    for(uint32_t n = top + 1; n-- > 1;){
+        if(mark[n] && aig.is_and(n)){
+            for(AigLit fanin: {aig.left[n], aig.right[n]}){
+                mark[aig_node(fanin)] |= aig_complemented(fanin) ? READ_COMPLEMENTED : READ;
+            }
+        }
+    }
+
+    std::vector<uint32_t> inputs;
+    for(uint32_t n = 1; n <= top; n++){
+        if(mark[n] && aig.is_input(n)){
+            inputs.push_back(n);
+        }
+    }
+    std::sort(inputs.begin(), inputs.end(), [&](uint32_t x, uint32_t y){
+        return aig.symbol[x] < aig.symbol[y];
+    });
+    std::vector<uint32_t> slot(top + 1, 0);
+    std::vector<uint32_t> complemented_slot(top + 1, 0);
+    for(auto n: inputs){
+        slot[n] = list.inputs.size();
+        list.inputs.push_back(aig.symbol[n]);
+    }
+    auto slot_of = [&](AigLit lit){
+        return aig_complemented(lit) ? complemented_slot[aig_node(lit)] : slot[aig_node(lit)];
+    };
+
+    for(uint32_t n = 1; n <= top; n++){
+        if(!mark[n]){
+            continue;
+        }
+        if(aig.is_and(n)){
+            list.gates.push_back({GateOp::AND, slot_of(aig.left[n]), slot_of(aig.right[n])});
+            slot[n] = list.slots() - 1;
+        }
+        if(mark[n] & READ_COMPLEMENTED){
+            list.gates.push_back({GateOp::NOT, slot[n], slot[n]});
+            complemented_slot[n] = list.slots() - 1;
+        }
+    }
+    list.output = slot_of(root);
+    return list;
+}
+
+uint64_t GateEvaluator::run() {
+    uint64_t* out = slot.data() + list.inputs.size();
+    for(auto& gate: list.gates){
+        uint64_t a = slot[gate.a];
+        uint64_t b = slot[gate.b];
+        switch(gate.op){
+            case GateOp::AND: *out = a & b; break;
+            case GateOp::OR: *out = a | b; break;
+            case GateOp::IMPLIES: *out = ~a | b; break;
+            case GateOp::EQ: *out = ~(a ^ b); break;
+            case GateOp::NOT: *out = ~a; break;
+            case GateOp::TRUE: *out = ~0ULL; break;
+            case GateOp::XOR: *out = a ^ b; break;
+        }
+        out++;
+    }
+    return slot[list.output];
+}
+
+bool GateEvaluator::evaluate(const Valuation& valuation) {
+    for(size_t i = 0; i < list.inputs.size(); i++){
+        slot[i] = valuation.get(list.inputs[i]) ? 1 : 0;
+    }
+    return run() & 1;
+}
+
+TruthValue KleeneEvaluator::run() {
+    uint32_t out = list.inputs.size();
+    for(auto& gate: list.gates){
+        uint64_t at = t[gate.a], af = f[gate.a];
+        uint64_t bt = t[gate.b], bf = f[gate.b];
+        switch(gate.op){
+            case GateOp::AND: t[out] = at & bt; f[out] = af | bf; break;
+            case GateOp::OR: t[out] = at | bt; f[out] = af & bf; break;
+            case GateOp::IMPLIES: t[out] = af | bt; f[out] = at & bf; break;
+            case GateOp::EQ: t[out] = (at & bt) | (af & bf); f[out] = (at & bf) | (af & bt); break;
+            case GateOp::NOT: t[out] = af; f[out] = at; break;
+            case GateOp::TRUE: t[out] = ~0ULL; f[out] = 0; break;
+            case GateOp::XOR: t[out] = (at & bf) | (af & bt); f[out] = (at & bt) | (af & bf); break;
+        }
+        out++;
+    }
+    if(t[list.output] & 1){
+        return TruthValue::TRUE;
+    }
+    return f[list.output] & 1 ? TruthValue::FALSE : TruthValue::UNKNOWN;
+}
+
+bool simulate(const GateList& list, uint64_t rounds, uint64_t seed, Valuation& model) {
+    GateEvaluator evaluator(list);
+    for(uint64_t round = 0; round < rounds; round++){
+        for(size_t i = 0; i < list.inputs.size(); i++){
+            seed += 0x9e3779b97f4a7c15ULL;
+            evaluator.slot[i] = mix64(seed);
+        }
+        uint64_t result = evaluator.run();
+        if(result != 0){
+            unsigned k = __builtin_ctzll(result);
+            for(size_t i = 0; i < list.inputs.size(); i++){
+                model.set(list.inputs[i], evaluator.slot[i] >> k & 1);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+// The exhaustive searches number valuations with a 64-bit counter, so they can
+// enumerate at most 63 inputs this way; more could never finish anyway, and
+// the shift that counts them would be undefined, so such a list is rejected.
+void require_countable(size_t counted, const char* engine) {
+    if(counted >= 64){
+        std::cerr << engine << ": cannot enumerate " << counted << " inputs with a 64-bit counter" << std::endl;
+        std::abort();
+    }
+}
+
+// Evaluates the gate list on one block of valuations at a time. Every thread
+// has its own evaluator, since the slots are scratch space.
+struct BlockEvaluator {
+    const GateList& list;
+    size_t inputs;
+    size_t counted;               // inputs enumerated by the block number
+    std::vector<Block> slot;
+
+    explicit BlockEvaluator(const GateList& list) : list(list), inputs(list.inputs.size()),
+            counted(inputs > BLOCK_INPUTS ? inputs - BLOCK_INPUTS : 0), slot(list.slots()) {
+        for(size_t i = 0; i < inputs && i < BLOCK_INPUTS; i++){
+            slot[i] = i < 6 ? broadcast(WORD_PATTERNS[i]) : lane_pattern(i - 6);
+        }
+        require_countable(counted, "sat_bitsliced");
+    }
+
+    // with fewer inputs than a block covers, the surplus bits repeat valuations
+    uint64_t blocks() const { return uint64_t(1) << counted; }
+
+    // evaluate block, and on a satisfying valuation write it to model
+    bool evaluate(uint64_t block, Valuation& model) {
+        for(size_t i = 0; i < counted; i++){
+            slot[BLOCK_INPUTS + i] = broadcast(block >> i & 1 ? ~0ULL : 0);
+        }
+
+        Block* out = slot.data() + inputs;
+        for(auto& gate: list.gates){
+            Block a = slot[gate.a];
+            Block b = slot[gate.b];
+            switch(gate.op){
+                case GateOp::AND: *out = a & b; break;
+                case GateOp::OR: *out = a | b; break;
+                case GateOp::IMPLIES: *out = ~a | b; break;
+                case GateOp::EQ: *out = ~(a ^ b); break;
+                case GateOp::NOT: *out = ~a; break;
+                case GateOp::TRUE: *out = ~Block{}; break;
+                case GateOp::XOR: *out = a ^ b; break;
+            }
+            out++;
+        }
+
+        Block result = slot[list.output];
+        for(unsigned lane = 0; lane < LANES; lane++){
+            if(result[lane] == 0){
+                continue;
+            }
+            unsigned t = __builtin_ctzll(result[lane]);
+            for(size_t i = 0; i < inputs; i++){
+                bool value = i < 6 ? t >> i & 1
+                    : i < BLOCK_INPUTS ? lane >> (i - 6) & 1
+                    : block >> (i - BLOCK_INPUTS) & 1;
+                model.set(list.inputs[i], value);
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// The prefixes a worker still has to search. The owner takes prefixes from the
+// front; an idle worker steals the back half.
+struct WorkRange {
+    std::mutex lock;
+    uint64_t next = 0;
+    uint64_t end = 0;
+
+    bool take(uint64_t& prefix) {
+        std::lock_guard<std::mutex> guard(lock);
+        if(next == end){
+            return false;
+        }
+        prefix = next++;
+        return true;
+    }
+
+    bool split(uint64_t& first, uint64_t& last) {
+        std::lock_guard<std::mutex> guard(lock);
+        if(next == end){
+            return false;
+        }
+        last = end;
+        first = end - (end - next + 1) / 2;
+        end = first;
+        return true;
+    }
+
+    void give(uint64_t first, uint64_t last) {
+        std::lock_guard<std::mutex> guard(lock);
+        next = first;
+        end = last;
+    }
+};
+
+struct ParallelSearch {
+    const GateList& list;
+    unsigned prefix_bits;       // counted inputs fixed by a prefix, the highest ones
+    std::vector<WorkRange> ranges;
+    std::atomic<bool> done{false};
+    Valuation& model;
+
+    ParallelSearch(const GateList& list, unsigned workers, unsigned prefix_bits, Valuation& model)
+        : list(list), prefix_bits(prefix_bits), ranges(workers), model(model) {}
+
+    void worker(unsigned id) {
+        BlockEvaluator evaluator(list);
+        Valuation found;
+        unsigned shift = evaluator.counted - prefix_bits;
+        uint64_t prefix;
+        while(next_prefix(id, prefix)){
+            uint64_t first = prefix << shift;
+            uint64_t last = (prefix + 1) << shift;
+            for(uint64_t block = first; block < last; block++){
+                if(done.load(std::memory_order_relaxed)){
+                    return;
+                }
+                if(evaluator.evaluate(block, found)){
+                    // the first worker to succeed reports its model and stops the rest
+                    bool expected = false;
+                    if(done.compare_exchange_strong(expected, true)){
+                        model = found;
+                    }
+                    return;
+                }
+            }
+        }
+    }
+
+    bool next_prefix(unsigned id, uint64_t& prefix) {
+        if(ranges[id].take(prefix)){
+            return true;
+        }
+        for(unsigned k = 1; k < ranges.size(); k++){
+            uint64_t first, last;
+            if(ranges[(id + k) % ranges.size()].split(first, last)){
+                ranges[id].give(first + 1, last);
+                prefix = first;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+}
+
+bool sat_bitsliced(const GateList& list, Valuation& model, unsigned threads) {
+    BlockEvaluator evaluator(list);
+    // below a few thousand blocks starting threads costs more than it saves
+    if(threads <= 1 || evaluator.counted < 12){
+        for(uint64_t block = 0; block < evaluator.blocks(); block++){
+            if(evaluator.evaluate(block, model)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // about 64 prefixes per worker keeps stealing rare but the load balanced
+    unsigned prefix_bits = 6;
+    while((1u << prefix_bits) < 64 * threads && prefix_bits < evaluator.counted - 6){
+        prefix_bits++;
+    }
+    ParallelSearch search(list, threads, prefix_bits, model);
+    uint64_t prefixes = uint64_t(1) << prefix_bits;
+    for(unsigned i = 0; i < threads; i++){
+        search.ranges[i].next = prefixes * i / threads;
+        search.ranges[i].end = prefixes * (i + 1) / threads;
+    }
+
+    std::vector<std::thread> pool;
+    for(unsigned i = 0; i < threads; i++){
+        pool.emplace_back(&ParallelSearch::worker, &search, i);
+    }
+    for(auto& thread: pool){
+        thread.join();
+    }
+    return search.done.load();
+}
+
+bool sat_graycode(const GateList& list, Valuation& model) {
+    size_t inputs = list.inputs.size();
+    require_countable(inputs, "sat_graycode");
+
+    // readers of every slot, as gate indices (compressed sparse rows)
+    std::vector<uint32_t> reader_start(list.slots() + 1, 0);
+    for(auto& gate: list.gates){
+        reader_start[gate.a + 1]++;
+        if(gate.b != gate.a){
+            reader_start[gate.b + 1]++;
+        }
+    }
+    for(size_t s = 0; s < list.slots(); s++){
+        reader_start[s + 1] += reader_start[s];
+    }
+    std::vector<uint32_t> readers(reader_start.back());
+    std::vector<uint32_t> fill(reader_start.begin(), reader_start.end() - 1);
+    for(uint32_t g = 0; g < list.gates.size(); g++){
+        readers[fill[list.gates[g].a]++] = g;
+        if(list.gates[g].b != list.gates[g].a){
+            readers[fill[list.gates[g].b]++] = g;
+        }
+    }
+
+    // start from the all-false valuation
+    std::vector<char> value(list.slots(), 0);
+    for(size_t g = 0; g < list.gates.size(); g++){
+        auto& gate = list.gates[g];
+        value[inputs + g] = evaluate_gate(gate.op, value[gate.a], value[gate.b]);
+    }
+
+    // gate indices are a topological order, so taking the smallest pending gate
+    // first evaluates every gate at most once per flip
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> pending;
+    std::vector<char> queued(list.gates.size(), 0);
+    auto schedule_readers = [&](uint32_t slot){
+        for(uint32_t r = reader_start[slot]; r < reader_start[slot + 1]; r++){
+            if(!queued[readers[r]]){
+                queued[readers[r]] = 1;
+                pending.push(readers[r]);
+            }
+        }
+    };
+
+    uint64_t valuations = uint64_t(1) << inputs;
+    for(uint64_t step = 1; !value[list.output]; step++){
+        if(step == valuations){
+            return false;
+        }
+        // step k of the Gray code flips the input at the lowest set bit of k
+        uint32_t flipped = __builtin_ctzll(step);
+        value[flipped] = !value[flipped];
+        schedule_readers(flipped);
+        while(!pending.empty()){
+            uint32_t g = pending.top();
+            pending.pop();
+            queued[g] = 0;
+            auto& gate = list.gates[g];
+            char result = evaluate_gate(gate.op, value[gate.a], value[gate.b]);
+            if(result != value[inputs + g]){
+                value[inputs + g] = result;
+                schedule_readers(inputs + g);
+            }
+        }
+    }
+
+    for(size_t i = 0; i < inputs; i++){
+        model.set(list.inputs[i], value[i]);
+    }
+    return true;
+}
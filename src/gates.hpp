@@ -0,0 +1,93 @@
+#ifndef __GATES__
+#define __GATES__
+#include "dagformula.hpp"
+#include "aig.hpp"
+
+enum class GateOp : uint8_t { AND, OR, IMPLIES, EQ, NOT, TRUE, XOR };
+
+// One two-input gate: out = a op b. A NOT gate reads only a (b == a), and the
+// TRUE gate of a formula that folded to a constant reads nothing (a == b == 0).
+struct Gate {
+    GateOp op;
+    uint32_t a;
+    uint32_t b;
+};
+
+// The cone of a DAG node as a straight-line circuit in topological order.
+// Slots 0 .. inputs.size()-1 hold the variables, and slot inputs.size() + i
+// holds the output of gates[i]. Gates with more than two children are split
+// into a chain of two-input gates, ITE(c, t, e) becomes (c => t) AND (c OR e),
+// ATLEAST(k, ...) becomes a sequential counter of AND and OR gates, and shared
+// subformulas appear once.
+struct GateList {
+    std::vector<uint32_t> inputs;   // symbol_table id of each input slot, increasing
+    std::vector<Gate> gates;
+    uint32_t output = 0;            // slot of the root
+
+    size_t slots() const { return inputs.size() + gates.size(); }
+};
+
+GateList compile_gates(const DAG& dag, NodeId root);
+// compile f through a temporary DAG, so shared subformulas become one gate
+GateList compile_gates(Formula* f);
+// the cone of an AIG edge as AND gates, plus one NOT gate per node that is read
+// through a complemented edge
+GateList compile_gates(const AIG& aig, AigLit root);
+
+// Interpreter for a gate list over 64-bit words: bit k of every slot belongs
+// to valuation k, so one run evaluates 64 valuations.
+struct GateEvaluator {
+    const GateList& list;
+    std::vector<uint64_t> slot;
+
+    explicit GateEvaluator(const GateList& list) : list(list), slot(list.slots(), 0) {}
+
+    // evaluate the gates on the input words in slot[0 .. inputs-1] and
+    // return the output word
+    uint64_t run();
+    // value of the list under a single valuation
+    bool evaluate(const Valuation& valuation);
+};
+
+// Kleene three-valued evaluation of a gate list on partial valuations, in
+// dual-rail form: bit k of t[s] / f[s] says that slot s is known TRUE / FALSE
+// in valuation k, and neither bit set means UNKNOWN. An input that is not
+// assigned yet is UNKNOWN, and a gate is known as soon as its known operands
+// decide it, e.g. AND with one FALSE operand.
+struct KleeneEvaluator {
+    const GateList& list;
+    std::vector<uint64_t> t;
+    std::vector<uint64_t> f;
+
+    explicit KleeneEvaluator(const GateList& list) : list(list), t(list.slots(), 0), f(list.slots(), 0) {}
+
+    void assign(uint32_t input, TruthValue value) {
+        t[input] = value == TruthValue::TRUE ? 1 : 0;
+        f[input] = value == TruthValue::FALSE ? 1 : 0;
+    }
+    // value of the output in valuation 0
+    TruthValue run();
+};
+
+// Evaluate the list on rounds * 64 pseudo-random valuations and write the first
+// satisfying one to model. Finding none proves nothing.
+bool simulate(const GateList& list, uint64_t rounds, uint64_t seed, Valuation& model);
+
+// Exhaustive search that evaluates the circuit on many valuations at once:
+// every slot holds one bit per valuation. The lowest input slots take fixed bit
+// patterns inside a block and the others are counted through, so the list may
+// have at most 63 inputs more than fit in a block. On success the satisfying
+// valuation is written to model.
+// With several threads the values of the highest inputs are split into prefixes
+// that workers take from their own queue or steal from another's; the first
+// worker to find a satisfying valuation cancels the others.
+bool sat_bitsliced(const GateList& list, Valuation& model, unsigned threads = 1);
+
+// Exhaustive search over one valuation at a time in Gray-code order, so that
+// consecutive valuations differ in a single input. The value of every slot is
+// kept between valuations; after a flip only the gates reading a changed slot
+// are re-evaluated, in topological order, and a gate whose value stays the same
+// stops the change there. The list may have at most 63 inputs.
+bool sat_graycode(const GateList& list, Valuation& model);
+
+#endif
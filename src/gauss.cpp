@@ -0,0 +1,351 @@
+#include "gauss.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+const unsigned BLOCK_BITS = 64 * LANES;
+
+// call f(col) for every set column of a row, in increasing order
+template<typename F>
+void for_each_column(const Block* row, size_t stride, F f) {
+    for(size_t b = 0; b < stride; b++){
+        for(unsigned lane = 0; lane < LANES; lane++){
+            uint64_t word = row[b][lane];
+            while(word){
+                f(uint32_t(b * BLOCK_BITS + lane * 64 + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+uint32_t find_root(std::vector<uint32_t>& parent, uint32_t x) {
+    while(parent[x] != x){
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// the equation of a node: the nodes it adds up and its right-hand side
+struct Equation {
+    NodeId node;
+    NodeId terms[3];
+    uint32_t count;
+    bool rhs;
+};
+}
+
+bool XorCluster::test(uint32_t r, uint32_t col) const {
+    return row(r)[col / BLOCK_BITS][col / 64 % LANES] >> (col % 64) & 1;
+}
+
+void XorCluster::flip(uint32_t r, uint32_t col) {
+    row(r)[col / BLOCK_BITS][col / 64 % LANES] ^= uint64_t(1) << (col % 64);
+}
+
+void XorSystem::build(const DAG& dag, size_t max_bits) {
+    auto linear = [&](NodeId n){ return dag.ops[n] == DAGOp::XOR || dag.ops[n] == DAGOp::EQ; };
+    std::vector<Equation> equations;
+    for(NodeId n = 0; n < dag.size(); n++){
+        auto kids = dag.children_of(n);
+        if(linear(n)){
+            equations.push_back({n, {n, kids[0], kids[1]}, 3, dag.ops[n] == DAGOp::EQ});
+        }
+        else if(dag.ops[n] == DAGOp::NOT){
+            // a negation joins the cluster of the XOR/EQ nodes it reads or feeds
+            auto parents = dag.parents_of(n);
+            if(linear(kids[0]) || std::any_of(parents.begin(), parents.end(), linear)){
+                equations.push_back({n, {n, kids[0]}, 2, true});
+            }
+        }
+    }
+
+    clusters.clear();
+    if(equations.size() < 2){
+        return;
+    }
+
+    // clusters are the connected components of nodes that share an equation
+    std::vector<uint32_t> parent(dag.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for(auto& e: equations){
+        for(uint32_t i = 1; i < e.count; i++){
+            parent[find_root(parent, e.terms[i])] = find_root(parent, e.terms[0]);
+        }
+    }
+    std::vector<uint32_t> equation_count(dag.size(), 0);
+    std::vector<uint32_t> column_count(dag.size(), 0);
+    std::vector<char> counted(dag.size(), 0);
+    for(auto& e: equations){
+        equation_count[find_root(parent, e.node)]++;
+        for(uint32_t i = 0; i < e.count; i++){
+            if(!counted[e.terms[i]]){
+                counted[e.terms[i]] = 1;
+                column_count[find_root(parent, e.terms[i])]++;
+            }
+        }
+    }
+
+    cluster_of.assign(dag.size(), NO_INDEX);
+    column_of.assign(dag.size(), NO_INDEX);
+    std::vector<uint32_t> cluster_of_root(dag.size(), NO_INDEX);
+    for(NodeId n = 0; n < dag.size(); n++){
+        if(!counted[n]){
+            continue;
+        }
+        uint32_t root = find_root(parent, n);
+        if(equation_count[root] < 2 || size_t(equation_count[root]) * column_count[root] > max_bits){
+            continue;
+        }
+        if(cluster_of_root[root] == NO_INDEX){
+            cluster_of_root[root] = clusters.size();
+            clusters.emplace_back();
+        }
+        // nodes are visited in increasing order, so columns are sorted
+        auto& c = clusters[cluster_of_root[root]];
+        cluster_of[n] = cluster_of_root[root];
+        column_of[n] = c.columns.size();
+        c.columns.push_back(n);
+    }
+
+    for(auto& c: clusters){
+        c.stride = (c.columns.size() + BLOCK_BITS - 1) / BLOCK_BITS;
+    }
+    for(auto& e: equations){
+        if(cluster_of[e.node] == NO_INDEX){
+            continue;
+        }
+        auto& c = clusters[cluster_of[e.node]];
+        uint32_t r = c.rows();
+        c.bits.resize((r + 1) * c.stride, Block{});
+        c.rhs.push_back(e.rhs);
+        for(uint32_t i = 0; i < e.count; i++){
+            c.flip(r, column_of[e.terms[i]]);
+        }
+        // the equation's own node is its preferred pivot
+        c.pivot.push_back(column_of[e.node]);
+    }
+
+    // Gauss-Jordan elimination: clear the earlier pivots from each row, pick
+    // its pivot, and clear that from the earlier rows. The equation of a node
+    // is the only one in which it is the highest column, so no row vanishes.
+    for(auto& c: clusters){
+        c.pivot_row.assign(c.columns.size(), NO_INDEX);
+        for(uint32_t r = 0; r < c.rows(); r++){
+            Block* target = c.row(r);
+            for(uint32_t earlier = 0; earlier < r; earlier++){
+                if(c.test(r, c.pivot[earlier])){
+                    const Block* source = c.row(earlier);
+                    for(size_t b = 0; b < c.stride; b++){
+                        target[b] ^= source[b];
+                    }
+                    c.rhs[r] ^= c.rhs[earlier];
+                }
+            }
+            if(!c.test(r, c.pivot[r])){
+                for_each_column(target, c.stride, [&](uint32_t col){ c.pivot[r] = col; });
+            }
+            c.pivot_row[c.pivot[r]] = r;
+            for(uint32_t earlier = 0; earlier < r; earlier++){
+                if(c.test(earlier, c.pivot[r])){
+                    Block* other = c.row(earlier);
+                    for(size_t b = 0; b < c.stride; b++){
+                        other[b] ^= target[b];
+                    }
+                    c.rhs[earlier] ^= c.rhs[r];
+                }
+            }
+        }
+
+        c.watch.assign(c.rows(), NO_INDEX);
+        c.watchers.assign(c.columns.size(), {});
+        for(uint32_t r = 0; r < c.rows(); r++){
+            for_each_column(c.row(r), c.stride, [&](uint32_t col){
+                if(col != c.pivot[r]){
+                    c.watch[r] = col;
+                }
+            });
+            if(c.watch[r] != NO_INDEX){
+                c.watchers[c.watch[r]].push_back(r);
+            }
+        }
+    }
+}
+
+uint32_t XorSystem::find_open(const Propagator& p, const XorCluster& c, uint32_t r) const {
+    const Block* row = c.row(r);
+    for(size_t b = 0; b < c.stride; b++){
+        for(unsigned lane = 0; lane < LANES; lane++){
+            uint64_t word = row[b][lane];
+            while(word){
+                uint32_t col = b * BLOCK_BITS + lane * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+                if(col != c.pivot[r] && p.dag.values[c.columns[col]] == TruthValue::UNKNOWN){
+                    return col;
+                }
+            }
+        }
+    }
+    return NO_INDEX;
+}
+
+void XorSystem::move_pivot(XorCluster& c, uint32_t r, uint32_t col) {
+    c.pivot_row[c.pivot[r]] = NO_INDEX;
+    c.pivot[r] = col;
+    c.pivot_row[col] = r;
+    const Block* source = c.row(r);
+    for(uint32_t other = 0; other < c.rows(); other++){
+        if(other != r && c.test(other, col)){
+            Block* target = c.row(other);
+            for(size_t b = 0; b < c.stride; b++){
+                target[b] ^= source[b];
+            }
+            c.rhs[other] ^= c.rhs[r];
+            pending.push_back(other);
+        }
+    }
+}
+
+bool XorSystem::settle(Propagator& p, XorCluster& c, uint32_t first) {
+    auto& values = p.dag.values;
+    bool ok = true;
+    pending.clear();
+    pending.push_back(first);
+    while(!pending.empty()){
+        uint32_t r = pending.back();
+        pending.pop_back();
+
+        // a labeled pivot gives way to an open column of its row
+        if(values[c.columns[c.pivot[r]]] != TruthValue::UNKNOWN){
+            uint32_t open = find_open(p, c, r);
+            if(open == NO_INDEX){
+                ok = ok && apply_row(p, c, r);
+                continue;
+            }
+            move_pivot(c, r, open);
+        }
+
+        // the pivot is open: keep an open watch beside it, or the row implies the pivot
+        uint32_t w = c.watch[r];
+        if(w != NO_INDEX && w != c.pivot[r] && c.test(r, w) && values[c.columns[w]] == TruthValue::UNKNOWN){
+            continue;
+        }
+        w = find_open(p, c, r);
+        bool unit = w == NO_INDEX;
+        if(unit){
+            for_each_column(c.row(r), c.stride, [&](uint32_t col){
+                if(col != c.pivot[r] && (w == NO_INDEX || p.trail_index[c.columns[col]] > p.trail_index[c.columns[w]])){
+                    w = col;
+                }
+            });
+        }
+        if(w != c.watch[r] && w != NO_INDEX){
+            c.watchers[w].push_back(r);
+        }
+        c.watch[r] = w;
+        if(unit){
+            ok = ok && apply_row(p, c, r);
+        }
+    }
+    return ok;
+}
+
+bool XorSystem::apply_row(Propagator& p, const XorCluster& c, uint32_t r) {
+    auto& values = p.dag.values;
+    bool parity = c.rhs[r];
+    uint32_t open = NO_INDEX;
+    uint32_t latest = NO_INDEX;
+    uint32_t open_count = 0;
+    for_each_column(c.row(r), c.stride, [&](uint32_t col){
+        NodeId node = c.columns[col];
+        if(values[node] == TruthValue::UNKNOWN){
+            open = col;
+            open_count++;
+        }
+        else{
+            parity ^= values[node] == TruthValue::TRUE;
+            if(latest == NO_INDEX || p.trail_index[node] > p.trail_index[c.columns[latest]]){
+                latest = col;
+            }
+        }
+    });
+    if(open_count > 1 || (open_count == 0 && !parity)){
+        return true;
+    }
+
+    // the open column takes the remaining parity; on a conflict the latest
+    // label is the one the others contradict
+    uint32_t target = open_count == 1 ? open : latest;
+    NodeId node = c.columns[target];
+    reasons.push_back({p.trail.size(), uint32_t(reason_nodes.size())});
+    for_each_column(c.row(r), c.stride, [&](uint32_t col){
+        if(col != target){
+            reason_nodes.push_back(c.columns[col]);
+        }
+    });
+    TruthValue value;
+    if(open_count == 1){
+        implied++;
+        value = parity ? TruthValue::TRUE : TruthValue::FALSE;
+    }
+    else{
+        conflicts++;
+        value = values[node] == TruthValue::TRUE ? TruthValue::FALSE : TruthValue::TRUE;
+    }
+    return p.assign(node, value, NO_NODE, XOR_REASON - int(reasons.size() - 1));
+}
+
+bool XorSystem::propagate_fixed(Propagator& p) {
+    for(auto& c: clusters){
+        for(uint32_t r = 0; r < c.rows(); r++){
+            if(c.watch[r] == NO_INDEX && !apply_row(p, c, r)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool XorSystem::propagate(Propagator& p, NodeId node) {
+    if(node >= cluster_of.size() || cluster_of[node] == NO_INDEX){
+        return true;
+    }
+    auto& c = clusters[cluster_of[node]];
+    uint32_t col = column_of[node];
+    bool ok = true;
+    if(c.pivot_row[col] != NO_INDEX){
+        ok = settle(p, c, c.pivot_row[col]);
+    }
+
+    // settling may append rows that come to watch this column, so index the
+    // list instead of holding iterators into it
+    auto& ws = c.watchers[col];
+    size_t i = 0, j = 0;
+    while(i < ws.size()){
+        uint32_t r = ws[i++];
+        if(c.watch[r] != col){
+            continue;   // stale entry
+        }
+        if(ok){
+            ok = settle(p, c, r);
+        }
+        if(c.watch[r] == col){
+            ws[j++] = r;
+        }
+    }
+    ws.resize(j);
+    return ok;
+}
+
+void XorSystem::explain(int index, std::vector<NodeId>& out) const {
+    uint32_t last = index + 1 < (int)reasons.size() ? reasons[index + 1].first : reason_nodes.size();
+    out.insert(out.end(), reason_nodes.begin() + reasons[index].first, reason_nodes.begin() + last);
+}
+
+void XorSystem::undo_to(size_t trail_size) {
+    while(!reasons.empty() && reasons.back().trail_position >= trail_size){
+        reason_nodes.resize(reasons.back().first);
+        reasons.pop_back();
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef __GAUSS__
+#define __GAUSS__
+#include "dagformula.hpp"
+#include "block.hpp"
+
+// no row, column or cluster
+const uint32_t NO_INDEX = 0xffffffff;
+
+// A connected group of XOR, EQ and NOT nodes as a system of linear equations
+// over GF(2): XOR node g with children a, b is g + a + b = 0, EQ is
+// g + a + b = 1 and NOT is g + a = 1. The columns are the nodes the equations
+// mention, and each row is a bit vector over them with its right-hand side.
+// The matrix is kept in reduced row echelon form: the pivot column of a row
+// appears in no other row. Like a clause, a row watches two columns that are
+// not labeled yet, its pivot and one other; when the pivot is labeled it is
+// swapped for an unlabeled column of its row, which is eliminated from every
+// other row. A row whose columns are all labeled but one implies that one, and
+// a fully labeled row with the wrong parity is a conflict; such a row watches
+// its most recently labeled column, which a backtrack unlabels first. Row
+// operations never need undoing: after a backtrack the matrix is still an
+// equivalent system.
+struct XorCluster {
+    std::vector<NodeId> columns;      // DAG node of each column, increasing
+    size_t stride = 0;                // blocks per row
+    std::vector<Block> bits;          // row r is bits[r * stride .. (r+1) * stride - 1]
+    std::vector<uint8_t> rhs;
+    std::vector<uint32_t> pivot;      // pivot column of each row
+    std::vector<uint32_t> pivot_row;  // row of each pivot column, NO_INDEX for the others
+    std::vector<uint32_t> watch;      // watched column of each row besides its pivot, NO_INDEX if none
+    std::vector<std::vector<uint32_t>> watchers;  // rows that may watch a column, stale entries allowed
+
+    size_t rows() const { return rhs.size(); }
+    Block* row(uint32_t r) { return bits.data() + r * stride; }
+    const Block* row(uint32_t r) const { return bits.data() + r * stride; }
+    bool test(uint32_t r, uint32_t col) const;
+    void flip(uint32_t r, uint32_t col);
+};
+
+// The XOR/EQ clusters of a DAG, propagated by Gaussian elimination next to the
+// labeling rules. A cluster of a single equation is left to the rules alone.
+struct XorSystem {
+    std::vector<XorCluster> clusters;
+    std::vector<uint32_t> cluster_of;   // cluster of each DAG node, NO_INDEX if none
+    std::vector<uint32_t> column_of;    // column of each DAG node in its cluster
+
+    size_t implied = 0;                 // labels implied by a row
+    size_t conflicts = 0;               // fully labeled rows with the wrong parity
+
+    // find the clusters of dag and bring their matrices to reduced form;
+    // clusters larger than max_bits are skipped
+    void build(const DAG& dag, size_t max_bits = size_t(1) << 26);
+    bool empty() const { return clusters.empty(); }
+
+    // label the nodes that a row fixes on its own, e.g. g in g <=> (a <=> NOT a);
+    // call at decision level 0, return false on conflict
+    bool propagate_fixed(Propagator& p);
+    // node was just labeled: move the watches of the rows that read it,
+    // labeling implied columns, return false on conflict
+    bool propagate(Propagator& p, NodeId node);
+    // append the nodes that implied the label with the given reason index
+    void explain(int index, std::vector<NodeId>& out) const;
+    // forget the reasons of labels at trail positions trail_size and above
+    void undo_to(size_t trail_size);
+
+private:
+    // the other columns of a row at the time it implied a label, kept until
+    // the label is undone
+    struct Reason {
+        size_t trail_position;
+        uint32_t first;     // reason_nodes[first .. next reason's first - 1]
+    };
+    std::vector<Reason> reasons;
+    std::vector<NodeId> reason_nodes;
+
+    std::vector<uint32_t> pending;      // rows to settle
+
+    // an unlabeled column of row r other than its pivot, NO_INDEX if none
+    uint32_t find_open(const Propagator& p, const XorCluster& c, uint32_t r) const;
+    // make col the pivot of row r, eliminating it from the other rows, which
+    // are queued to be settled
+    void move_pivot(XorCluster& c, uint32_t r, uint32_t col);
+    // restore the watches of row r and of the rows its pivot moves change,
+    // applying the rows that have at most one open column left
+    bool settle(Propagator& p, XorCluster& c, uint32_t r);
+    // label the last open column of row r or detect its conflict
+    bool apply_row(Propagator& p, const XorCluster& c, uint32_t r);
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "jit.hpp"
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__unix__)
+#include <sys/mman.h>
+#include <cstring>
+
+namespace {
+// x86-64 encodings of "op rax, [rdi + disp32]" (REX.W, opcode, ModRM 10 000 111)
+const uint8_t LOAD[] = {0x48, 0x8b, 0x87};
+const uint8_t STORE[] = {0x48, 0x89, 0x87};
+const uint8_t AND_MEM[] = {0x48, 0x23, 0x87};
+const uint8_t OR_MEM[] = {0x48, 0x0b, 0x87};
+const uint8_t XOR_MEM[] = {0x48, 0x33, 0x87};
+const uint8_t NOT_RAX[] = {0x48, 0xf7, 0xd0};
+// "or rax, imm8" with the sign-extended immediate -1 appended
+const uint8_t OR_RAX_IMM8[] = {0x48, 0x83, 0xc8};
+const uint8_t RET = 0xc3;
+
+struct Emitter {
+    std::vector<uint8_t> bytes;
+
+    void emit(const uint8_t (&op)[3]) {
+        bytes.insert(bytes.end(), op, op + 3);
+    }
+    // op with the operand slot of the System V first argument (rdi)
+    void emit(const uint8_t (&op)[3], uint32_t slot) {
+        emit(op);
+        uint32_t disp = slot * 8;
+        uint8_t le[4];
+        std::memcpy(le, &disp, 4);
+        bytes.insert(bytes.end(), le, le + 4);
+    }
+};
+}
+
+JitEvaluator::JitEvaluator(const GateList& list) : interpreter(list) {
+    // displacements are signed 32-bit
+    if(list.slots() >= (uint32_t(1) << 28)){
+        return;
+    }
+
+    Emitter e;
+    // rax keeps the last result, so a gate reading its predecessor skips the load
+    uint32_t in_rax = UINT32_MAX;
+    uint32_t out = list.inputs.size();
+    for(auto& gate: list.gates){
+        uint32_t other = gate.b;
+        if(in_rax == gate.b && gate.op != GateOp::IMPLIES){
+            other = gate.a;   // the commutative ops may take their operands swapped
+        }
+        else if(in_rax != gate.a && gate.op != GateOp::TRUE){
+            e.emit(LOAD, gate.a);
+        }
+        switch(gate.op){
+            case GateOp::AND: e.emit(AND_MEM, other); break;
+            case GateOp::OR: e.emit(OR_MEM, other); break;
+            case GateOp::IMPLIES: e.emit(NOT_RAX); e.emit(OR_MEM, gate.b); break;
+            case GateOp::EQ: e.emit(XOR_MEM, other); e.emit(NOT_RAX); break;
+            case GateOp::NOT: e.emit(NOT_RAX); break;
+            case GateOp::TRUE: e.emit(OR_RAX_IMM8); e.bytes.push_back(0xff); break;
+            case GateOp::XOR: e.emit(XOR_MEM, other); break;
+        }
+        e.emit(STORE, out);
+        in_rax = out++;
+    }
+    if(in_rax != list.output){
+        e.emit(LOAD, list.output);
+    }
+    e.bytes.push_back(RET);
+
+    void* buffer = mmap(nullptr, e.bytes.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(buffer == MAP_FAILED){
+        return;
+    }
+    std::memcpy(buffer, e.bytes.data(), e.bytes.size());
+    if(mprotect(buffer, e.bytes.size(), PROT_READ | PROT_EXEC) != 0){
+        munmap(buffer, e.bytes.size());
+        return;
+    }
+    code = reinterpret_cast<uint64_t (*)(uint64_t*)>(buffer);
+    code_size = e.bytes.size();
+}
+
+JitEvaluator::~JitEvaluator() {
+    if(code){
+        munmap(reinterpret_cast<void*>(code), code_size);
+    }
+}
+
+#else
+
+JitEvaluator::JitEvaluator(const GateList& list) : interpreter(list) {}
+JitEvaluator::~JitEvaluator() {}
+
+#endif
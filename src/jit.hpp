@@ -0,0 +1,27 @@
+#ifndef __JIT__
+#define __JIT__
+#include "gates.hpp"
+
+// Evaluates a gate list with native code: the gates are translated once to
+// straight-line x86-64 (a load, one or two ALU ops and a store per gate on a
+// 64-bit register) in an mmap'd executable buffer, which run() calls. On other
+// targets, or when the buffer cannot be mapped, run() uses the interpreter.
+struct JitEvaluator {
+    GateEvaluator interpreter;
+    std::vector<uint64_t>& slot = interpreter.slot;   // same layout as the interpreter
+
+    explicit JitEvaluator(const GateList& list);
+    JitEvaluator(const JitEvaluator&) = delete;
+    JitEvaluator& operator=(const JitEvaluator&) = delete;
+    ~JitEvaluator();
+
+    bool native() const { return code != nullptr; }
+    // evaluate the gates on the input words in slot and return the output word
+    uint64_t run() { return code ? code(slot.data()) : interpreter.run(); }
+
+private:
+    uint64_t (*code)(uint64_t*) = nullptr;
+    size_t code_size = 0;
+};
+
+#endif
@@ -1,13 +1,22 @@
 #include "formula.hpp"
 #include "truthtable.hpp"
 #include "dagformula.hpp"
+#include "dagsolver.hpp"
+#include "gates.hpp"
+#include "aig.hpp"
+#include "normalize.hpp"
+#include "cardinality.hpp"
 #include "test_formulas.hpp"
+#include "benchmarks.hpp"
 #include <iostream>
 #include <cstring>
 
 extern int yyparse();
 extern Formula* parsed_formula;
 
+// formulas with more variables skip the truth-table reference
+const size_t REFERENCE_MAX_VARS = 20;
+
 int main(int argc, char* argv[]){
     // Check for -t flag
     if(argc > 1 && strcmp(argv[1], "-t") == 0) {
@@ -15,6 +24,10 @@ int main(int argc, char* argv[]){
         test_formulas();
         return 0;
     }
+    if(argc > 1 && strcmp(argv[1], "-b") == 0) {
+        run_benchmarks();
+        return 0;
+    }
 
     // Parse formula from stdin
     std::cout << "Enter formula (end with semicolon): ";
@@ -30,19 +43,55 @@ int main(int argc, char* argv[]){
     formula->print();
     std::cout << std::endl << "signature: " << formula->signature() << std::endl;
 
-    auto is_satisfiable = sat_truthtable(formula);
-    auto str = is_satisfiable?"":"not ";
-    std::cout << std::endl << "this formula is " << str << "satisfiable" << std::endl;
+    // the reference enumeration takes 2^n evaluations, so it only checks
+    // formulas with few variables; the search below answers for the rest
+    bool is_satisfiable = false;
+    if(formula->get_vars().size() <= REFERENCE_MAX_VARS){
+        is_satisfiable = sat_truthtable(formula);
+        auto str = is_satisfiable?"":"not ";
+        std::cout << std::endl << "this formula is " << str << "satisfiable" << std::endl;
+    }
 
-    // Build DAG and label
-    std::map<std::string, DAGNode*> node_map;
-    auto dag = build_dag(formula, node_map, nullptr);
-    dag->print();
+    // Build DAG and search for a labeling with the root TRUE
+    DAG dag;
+    auto root = build_dag(formula, dag);
+    dag.print(root);
     std::cout << std::endl;
+    AIG aig;
+    build_aig(formula, aig);
+    std::cout << "dag nodes: " << dag.size() << ", and-inverter graph: " << aig.and_count << " AND nodes over "
+              << aig.size() - 1 - aig.and_count << " inputs" << std::endl;
+    Arena normal_arena;
+    auto report = compare_normal_form(formula, normalize(formula, normal_arena));
+    std::cout << "normal form: " << report.nodes_after << " dag nodes, " << report.merged() << " merged" << std::endl;
 
-    is_satisfiable = dag->label(TruthValue::TRUE, 0, TruthValueChangeReason::TRIGGER);
-    str = is_satisfiable?"":"not ";
-    std::cout << "After labeling the root as TRUE dag is " << str << "satisfiable" << std::endl;
+    // the search runs on the DAG with pairwise at-most-one encodings collapsed
+    DAG collapsed;
+    CardinalityReport cardinality;
+    auto collapsed_root = collapse_at_most_one(dag, root, collapsed, cardinality);
+    std::cout << "at-most-one groups: " << cardinality.groups << " replacing " << cardinality.pairs << " exclusions" << std::endl;
+
+    // random valuations often hit a model of an easy formula, and then the
+    // search is not needed
+    Valuation model(symbol_table.size());
+    if(simulate(compile_gates(collapsed, collapsed_root), 16, 1, model)){
+        is_satisfiable = true;
+        std::cout << "random simulation: found a model" << std::endl;
+    }
+    else{
+        DAGSolver solver(collapsed, collapsed_root);
+        is_satisfiable = solver.solve();
+        auto str = is_satisfiable?"":"not ";
+        std::cout << "dag search: this formula is " << str << "satisfiable" << std::endl;
+        model = solver.model();
+    }
+    if(is_satisfiable){
+        // checked on the formula tree, independently of the DAG
+        for(auto var: formula->get_vars()){
+            std::cout << symbol_table.name(var) << " = " << (model.get(var) ? "true" : "false") << std::endl;
+        }
+        std::cout << "model check: " << (formula->solve(model) ? "ok" : "failed") << std::endl;
+    }
 
     return 0;
 } 
\ No newline at end of file
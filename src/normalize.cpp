@@ -0,0 +1,169 @@
+#include "normalize.hpp"
+#include "dagformula.hpp"
+
+namespace {
+// A formula node being normalized and its operands, laid out like the frames
+// of build_dag(): a maximal AND (OR) chain contributes the subformulas below it.
+struct NormalizeFrame {
+    Formula* node;
+    size_t first;   // operands[first .. last-1]
+    size_t last;
+    size_t next;    // next operand to normalize
+};
+
+struct Normalizer {
+    Arena& arena;
+
+    bool negated(Formula* f) const { return f->op == FormulaOp::NOT; }
+
+    Formula* negate(Formula* f) {
+        if(f->op == FormulaOp::CONST){
+            return arena.make<Constant>(!static_cast<Constant*>(f)->value);
+        }
+        return negated(f) ? f->child(0) : arena.make<Not>(f);
+    }
+
+    Formula* chain(FormulaOp op, Formula** parts, size_t count) {
+        Formula* f = parts[0];
+        for(size_t i = 1; i < count; i++){
+            f = op == FormulaOp::AND ? (Formula*)arena.make<And>(f, parts[i]) : arena.make<Or>(f, parts[i]);
+        }
+        return f;
+    }
+
+    // AND/OR of parts: all negated turns into the negated dual over the plain
+    // parts, and NOT a OR b into a => b
+    Formula* junction(FormulaOp op, Formula** parts, size_t count) {
+        size_t negations = 0;
+        for(size_t i = 0; i < count; i++){
+            negations += negated(parts[i]);
+        }
+        if(negations == count){
+            for(size_t i = 0; i < count; i++){
+                parts[i] = parts[i]->child(0);
+            }
+            return negate(chain(op == FormulaOp::AND ? FormulaOp::OR : FormulaOp::AND, parts, count));
+        }
+        if(op == FormulaOp::OR && count == 2 && negations == 1){
+            size_t antecedent = negated(parts[0]) ? 0 : 1;
+            return arena.make<Implies>(parts[antecedent]->child(0), parts[1 - antecedent]);
+        }
+        return chain(op, parts, count);
+    }
+
+    Formula* combine(Formula* node, Formula** parts, size_t count) {
+        switch(node->op){
+            case FormulaOp::VAR:
+            case FormulaOp::CONST:
+                return node;
+            case FormulaOp::NOT:
+                return negate(parts[0]);
+            case FormulaOp::AND:
+            case FormulaOp::OR:
+                return junction(node->op, parts, count);
+            case FormulaOp::IMPLIES: {
+                Formula* disjuncts[2] = {negate(parts[0]), parts[1]};
+                return junction(FormulaOp::OR, disjuncts, 2);
+            }
+            case FormulaOp::ITE: {
+                // a negated condition swaps the branches, and a negation on
+                // both branches moves out of them
+                Formula* c = parts[0];
+                Formula* t = parts[1];
+                Formula* e = parts[2];
+                if(negated(c)){
+                    c = c->child(0);
+                    std::swap(t, e);
+                }
+                if(negated(t) && negated(e)){
+                    return negate(arena.make<Ite>(c, t->child(0), e->child(0)));
+                }
+                return arena.make<Ite>(c, t, e);
+            }
+            case FormulaOp::ATLEAST: {
+                // k of n operands hold exactly when at most n - k of their
+                // negations do
+                uint32_t bound = static_cast<AtLeast*>(node)->bound;
+                size_t negations = 0;
+                for(size_t i = 0; i < count; i++){
+                    negations += negated(parts[i]);
+                }
+                if(2 * negations <= count || bound > count){
+                    return make_at_least(arena, bound, parts, count);
+                }
+                for(size_t i = 0; i < count; i++){
+                    parts[i] = negate(parts[i]);
+                }
+                return negate(make_at_least(arena, count - bound + 1, parts, count));
+            }
+            case FormulaOp::EQ:
+            case FormulaOp::XOR:
+                break;
+        }
+        // a XOR b is NOT (a <=> b); negations move out of an equivalence and
+        // cancel in pairs
+        bool flip = (negated(parts[0]) != negated(parts[1])) != (node->op == FormulaOp::XOR);
+        Formula* left = negated(parts[0]) ? parts[0]->child(0) : parts[0];
+        Formula* right = negated(parts[1]) ? parts[1]->child(0) : parts[1];
+        Formula* eq = arena.make<Eq>(left, right);
+        return flip ? negate(eq) : eq;
+    }
+};
+}
+
+Formula* normalize(Formula* f, Arena& arena) {
+    // post-order with explicit stacks, as in build_dag()
+    Normalizer normalizer{arena};
+    std::vector<Formula*> operands;
+    std::vector<Formula*> pending;
+    std::vector<Formula*> values;
+    std::vector<NormalizeFrame> stack;
+    auto push = [&](Formula* node){
+        size_t first = operands.size();
+        if(node->op == FormulaOp::AND || node->op == FormulaOp::OR){
+            pending.push_back(node);
+            while(!pending.empty()){
+                auto inner = pending.back();
+                pending.pop_back();
+                for(size_t i = 0; i < inner->arity(); i++){
+                    auto child = inner->child(i);
+                    (child->op == node->op ? pending : operands).push_back(child);
+                }
+            }
+        }
+        else{
+            for(size_t i = 0; i < node->arity(); i++){
+                operands.push_back(node->child(i));
+            }
+        }
+        stack.push_back({node, first, operands.size(), first});
+    };
+
+    push(f);
+    while(!stack.empty()){
+        auto& top = stack.back();
+        if(top.next < top.last){
+            push(operands[top.next++]);
+            continue;
+        }
+        size_t count = top.last - top.first;
+        Formula** parts = values.data() + values.size() - count;
+        Formula* result = normalizer.combine(top.node, parts, count);
+        values.resize(values.size() - count);
+        operands.resize(top.first);
+        stack.pop_back();
+        values.push_back(result);
+    }
+    return values.back();
+}
+
+NormalizeReport compare_normal_form(Formula* f, Formula* normal) {
+    NormalizeReport report;
+    DAG dag;
+    build_dag(f, dag);
+    report.nodes_before = dag.size();
+    dag.clear();
+    build_dag(normal, dag);
+    report.nodes_after = dag.size();
+    return report;
+}
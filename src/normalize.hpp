@@ -0,0 +1,38 @@
+#ifndef __NORMALIZE__
+#define __NORMALIZE__
+#include "formula.hpp"
+#include "arena.hpp"
+
+// Rewrite f into a sign-normal form, allocating the new inner nodes in arena,
+// so that subformulas that differ only in how their negations are written
+// become structurally equal and share DAG nodes:
+// - double negations cancel;
+// - an AND (OR) chain whose operands are all negated becomes the negated OR
+//   (AND) of the plain operands, so NOT a OR NOT b and NOT (a AND b) agree;
+// - a => b and NOT a OR b become a => b, NOT a => b becomes a OR b, and
+//   a => NOT b becomes NOT (a AND b);
+// - a XOR b becomes NOT (a <=> b), and negated operands of an equivalence
+//   move out of it and cancel in pairs;
+// - ITE(NOT c, t, e) becomes ITE(c, e, t), and ITE(c, NOT t, NOT e) becomes
+//   NOT ITE(c, t, e);
+// - at least k of n operands, more than half of them negated, becomes at most
+//   n - k of the flipped operands, NOT ATLEAST(n - k + 1, ...).
+// Negations are pulled up to the gates rather than pushed down to the
+// variables as in negation normal form, which would give a subformula used in
+// both polarities two copies.
+// The variables of f are reused, so the result must not outlive them.
+Formula* normalize(Formula* f, Arena& arena);
+
+// Sizes of the DAGs of a formula as written and of its normal form.
+struct NormalizeReport {
+    size_t nodes_before = 0;
+    size_t nodes_after = 0;
+
+    // nodes saved by normalizing, negative in the rare case that a rewrite
+    // needs a node more than it merges
+    long merged() const { return (long)nodes_before - (long)nodes_after; }
+};
+
+NormalizeReport compare_normal_form(Formula* f, Formula* normal);
+
+#endif
@@ -1,3 +1,4 @@
 #include "fol.hpp"
 
 ::Formula* parsed_formula = nullptr;
+Arena parsed_arena;
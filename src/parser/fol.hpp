@@ -2,7 +2,10 @@
 #define _FOL_H
 
 #include "../formula.hpp"
+#include "../arena.hpp"
 
 extern ::Formula* parsed_formula;
+// owns the nodes of parsed_formula
+extern Arena parsed_arena;
 
 #endif
@@ -71,7 +71,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 
 int yylex();
 
@@ -85,8 +87,21 @@ void yyerror(const char* msg) {
 
 using std::string;
 
+// at least bound of operands, taking ownership of the list; every bound
+// above the number of operands is the same unsatisfiable constraint
+static ::Formula* at_least(uint64_t bound, std::vector< ::Formula*>* operands) {
+    bound = std::min<uint64_t>(bound, operands->size() + 1);
+    ::Formula* f = make_at_least(parsed_arena, bound, operands->data(), operands->size());
+    delete operands;
+    return f;
+}
+
+// the right-recursive rules keep a whole chain of operators on the parser
+// stack, so let it grow with memory instead of stopping at 10000 entries
+#define YYMAXDEPTH 100000000
 
-#line 90 "parser/parser.cpp"
+
+#line 105 "parser/parser.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -123,19 +138,31 @@ enum yysymbol_kind_t
   YYSYMBOL_OR = 6,                         /* OR  */
   YYSYMBOL_IMP = 7,                        /* IMP  */
   YYSYMBOL_IFF = 8,                        /* IFF  */
-  YYSYMBOL_9_ = 9,                         /* ';'  */
-  YYSYMBOL_10_ = 10,                       /* '('  */
-  YYSYMBOL_11_ = 11,                       /* ')'  */
-  YYSYMBOL_YYACCEPT = 12,                  /* $accept  */
-  YYSYMBOL_input = 13,                     /* input  */
-  YYSYMBOL_formula = 14,                   /* formula  */
-  YYSYMBOL_iff_formula = 15,               /* iff_formula  */
-  YYSYMBOL_imp_formula = 16,               /* imp_formula  */
-  YYSYMBOL_or_formula = 17,                /* or_formula  */
-  YYSYMBOL_and_formula = 18,               /* and_formula  */
-  YYSYMBOL_unary_formula = 19,             /* unary_formula  */
-  YYSYMBOL_sub_formula = 20,               /* sub_formula  */
-  YYSYMBOL_atomic_formula = 21             /* atomic_formula  */
+  YYSYMBOL_TRUE = 9,                       /* TRUE  */
+  YYSYMBOL_FALSE = 10,                     /* FALSE  */
+  YYSYMBOL_ATLEAST = 11,                   /* ATLEAST  */
+  YYSYMBOL_ATMOST = 12,                    /* ATMOST  */
+  YYSYMBOL_NUMBER = 13,                    /* NUMBER  */
+  YYSYMBOL_14_ = 14,                       /* ';'  */
+  YYSYMBOL_15_ = 15,                       /* '?'  */
+  YYSYMBOL_16_ = 16,                       /* ':'  */
+  YYSYMBOL_17_ = 17,                       /* '^'  */
+  YYSYMBOL_18_ = 18,                       /* '('  */
+  YYSYMBOL_19_ = 19,                       /* ')'  */
+  YYSYMBOL_20_ = 20,                       /* ','  */
+  YYSYMBOL_YYACCEPT = 21,                  /* $accept  */
+  YYSYMBOL_input = 22,                     /* input  */
+  YYSYMBOL_formula = 23,                   /* formula  */
+  YYSYMBOL_ite_formula = 24,               /* ite_formula  */
+  YYSYMBOL_iff_formula = 25,               /* iff_formula  */
+  YYSYMBOL_xor_formula = 26,               /* xor_formula  */
+  YYSYMBOL_imp_formula = 27,               /* imp_formula  */
+  YYSYMBOL_or_formula = 28,                /* or_formula  */
+  YYSYMBOL_and_formula = 29,               /* and_formula  */
+  YYSYMBOL_unary_formula = 30,             /* unary_formula  */
+  YYSYMBOL_sub_formula = 31,               /* sub_formula  */
+  YYSYMBOL_atomic_formula = 32,            /* atomic_formula  */
+  YYSYMBOL_formula_list = 33               /* formula_list  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -461,21 +488,21 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  15
+#define YYFINAL  23
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   18
+#define YYLAST   48
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  12
+#define YYNTOKENS  21
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  10
+#define YYNNTS  13
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  16
+#define YYNRULES  26
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  26
+#define YYNSTATES  51
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   263
+#define YYMAXUTOK   268
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -493,12 +520,12 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      10,    11,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,     9,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      18,    19,     2,     2,    20,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    16,    14,
+       2,     2,     2,    15,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,    17,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -515,15 +542,16 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
-       5,     6,     7,     8
+       5,     6,     7,     8,     9,    10,    11,    12,    13
 };
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_int8 yyrline[] =
+static const yytype_uint8 yyrline[] =
 {
-       0,    44,    44,    51,    56,    60,    66,    70,    76,    80,
-      86,    90,    96,   100,   106,   110,   116
+       0,    69,    69,    76,    81,    85,    90,    94,   100,   104,
+     110,   114,   120,   124,   130,   134,   140,   144,   150,   154,
+     160,   165,   169,   173,   177,   183,   188
 };
 #endif
 
@@ -540,9 +568,11 @@ static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 static const char *const yytname[] =
 {
   "\"end of file\"", "error", "\"invalid token\"", "SYMBOL", "NOT", "AND",
-  "OR", "IMP", "IFF", "';'", "'('", "')'", "$accept", "input", "formula",
-  "iff_formula", "imp_formula", "or_formula", "and_formula",
-  "unary_formula", "sub_formula", "atomic_formula", YY_NULLPTR
+  "OR", "IMP", "IFF", "TRUE", "FALSE", "ATLEAST", "ATMOST", "NUMBER",
+  "';'", "'?'", "':'", "'^'", "'('", "')'", "','", "$accept", "input",
+  "formula", "ite_formula", "iff_formula", "xor_formula", "imp_formula",
+  "or_formula", "and_formula", "unary_formula", "sub_formula",
+  "atomic_formula", "formula_list", YY_NULLPTR
 };
 
 static const char *
@@ -552,7 +582,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-8)
+#define YYPACT_NINF (-24)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -566,9 +596,12 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-      -1,    -8,    -1,    -1,     1,    -5,    -8,    -3,     0,     3,
-      -8,    -8,    -8,    -8,     2,    -8,    -8,    -1,    -1,    -1,
-      -1,    -8,    -8,     3,    -8,    -8
+       2,   -24,     2,   -24,   -24,     6,     7,     2,    17,    12,
+     -24,    13,     1,   -24,    -3,    16,   -24,   -24,   -24,   -24,
+      14,    18,    11,   -24,   -24,     2,     2,     2,     2,     2,
+       2,    15,    19,   -24,    20,   -24,   -24,    16,   -24,   -24,
+       2,     2,     2,   -24,    -4,     3,   -24,   -24,     2,   -24,
+     -24
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -576,21 +609,26 @@ static const yytype_int8 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,    16,     0,     0,     0,     0,     3,     5,     7,     9,
-      11,    13,    14,    12,     0,     1,     2,     0,     0,     0,
-       0,    15,     4,     8,     6,    10
+       0,    20,     0,    21,    22,     0,     0,     0,     0,     0,
+       3,     5,     7,     9,    11,    13,    15,    17,    18,    16,
+       0,     0,     0,     1,     2,     0,     0,     0,     0,     0,
+       0,     0,     0,    19,     0,     6,     8,    12,    10,    14,
+       0,     0,     0,    26,     0,     0,     4,    23,     0,    24,
+      25
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-      -8,    -8,     7,    -6,    -7,    -8,    -4,    -2,    -8,    -8
+     -24,   -24,     0,   -23,     8,   -24,   -19,   -24,     4,    -1,
+     -24,   -24,    -8
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     4,     5,     6,     7,     8,     9,    10,    11,    12
+       0,     8,    43,    10,    11,    12,    13,    14,    15,    16,
+      17,    18,    44
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -598,37 +636,48 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int8 yytable[] =
 {
-      13,    15,     1,     2,    16,    17,    18,    19,    20,     3,
-      14,    22,    24,    21,    23,     0,     0,     0,    25
+       9,    19,    34,    28,    29,     1,     2,    22,    36,    26,
+      38,     3,     4,     5,     6,    47,    48,    23,    27,    46,
+       7,    30,    49,    48,    20,    21,    24,    31,    25,    39,
+      33,    32,    37,    45,    35,    40,    42,     0,     0,    41,
+       0,     0,     0,     0,     0,     0,     0,     0,    50
 };
 
 static const yytype_int8 yycheck[] =
 {
-       2,     0,     3,     4,     9,     8,     6,     7,     5,    10,
-       3,    17,    19,    11,    18,    -1,    -1,    -1,    20
+       0,     2,    25,     6,     7,     3,     4,     7,    27,     8,
+      29,     9,    10,    11,    12,    19,    20,     0,    17,    42,
+      18,     5,    19,    20,    18,    18,    14,    13,    15,    30,
+      19,    13,    28,    41,    26,    20,    16,    -1,    -1,    20,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    48
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,     3,     4,    10,    13,    14,    15,    16,    17,    18,
-      19,    20,    21,    19,    14,     0,     9,     8,     6,     7,
-       5,    11,    15,    18,    16,    19
+       0,     3,     4,     9,    10,    11,    12,    18,    22,    23,
+      24,    25,    26,    27,    28,    29,    30,    31,    32,    30,
+      18,    18,    23,     0,    14,    15,     8,    17,     6,     7,
+       5,    13,    13,    19,    24,    25,    27,    29,    27,    30,
+      20,    20,    16,    23,    33,    33,    24,    19,    20,    19,
+      23
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    12,    13,    14,    15,    15,    16,    16,    17,    17,
-      18,    18,    19,    19,    20,    20,    21
+       0,    21,    22,    23,    24,    24,    25,    25,    26,    26,
+      27,    27,    28,    28,    29,    29,    30,    30,    31,    31,
+      32,    32,    32,    32,    32,    33,    33
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
-       0,     2,     2,     1,     3,     1,     3,     1,     3,     1,
-       3,     1,     2,     1,     1,     3,     1
+       0,     2,     2,     1,     5,     1,     3,     1,     3,     1,
+       3,     1,     3,     1,     3,     1,     2,     1,     1,     3,
+       1,     1,     1,     6,     6,     3,     1
 };
 
 
@@ -1092,129 +1141,210 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* input: formula ';'  */
-#line 45 "parser/parser.ypp"
+#line 70 "parser/parser.ypp"
        {
          parsed_formula = (yyvsp[-1].formula_attr);
 	 return 0;
        }
-#line 1101 "parser/parser.cpp"
+#line 1150 "parser/parser.cpp"
     break;
 
-  case 3: /* formula: iff_formula  */
-#line 52 "parser/parser.ypp"
+  case 3: /* formula: ite_formula  */
+#line 77 "parser/parser.ypp"
         {
 	 (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	}
-#line 1109 "parser/parser.cpp"
+#line 1158 "parser/parser.cpp"
     break;
 
-  case 4: /* iff_formula: imp_formula IFF iff_formula  */
-#line 57 "parser/parser.ypp"
+  case 4: /* ite_formula: iff_formula '?' ite_formula ':' ite_formula  */
+#line 82 "parser/parser.ypp"
         {
-	  (yyval.formula_attr) = new ::Eq((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
+	  (yyval.formula_attr) = parsed_arena.make< ::Ite>((yyvsp[-4].formula_attr), (yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
 	}
-#line 1117 "parser/parser.cpp"
+#line 1166 "parser/parser.cpp"
     break;
 
-  case 5: /* iff_formula: imp_formula  */
-#line 61 "parser/parser.ypp"
+  case 5: /* ite_formula: iff_formula  */
+#line 86 "parser/parser.ypp"
         {
 	  (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	}
-#line 1125 "parser/parser.cpp"
+#line 1174 "parser/parser.cpp"
+    break;
+
+  case 6: /* iff_formula: xor_formula IFF iff_formula  */
+#line 91 "parser/parser.ypp"
+        {
+	  (yyval.formula_attr) = parsed_arena.make< ::Eq>((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
+	}
+#line 1182 "parser/parser.cpp"
     break;
 
-  case 6: /* imp_formula: or_formula IMP imp_formula  */
-#line 67 "parser/parser.ypp"
+  case 7: /* iff_formula: xor_formula  */
+#line 95 "parser/parser.ypp"
+        {
+	  (yyval.formula_attr) = (yyvsp[0].formula_attr);
+	}
+#line 1190 "parser/parser.cpp"
+    break;
+
+  case 8: /* xor_formula: xor_formula '^' imp_formula  */
+#line 101 "parser/parser.ypp"
             {
-	      (yyval.formula_attr) = new ::Implies((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
+	      (yyval.formula_attr) = parsed_arena.make< ::Xor>((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
 	    }
-#line 1133 "parser/parser.cpp"
+#line 1198 "parser/parser.cpp"
     break;
 
-  case 7: /* imp_formula: or_formula  */
-#line 71 "parser/parser.ypp"
+  case 9: /* xor_formula: imp_formula  */
+#line 105 "parser/parser.ypp"
             {
 	      (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	    }
-#line 1141 "parser/parser.cpp"
+#line 1206 "parser/parser.cpp"
     break;
 
-  case 8: /* or_formula: or_formula OR and_formula  */
-#line 77 "parser/parser.ypp"
+  case 10: /* imp_formula: or_formula IMP imp_formula  */
+#line 111 "parser/parser.ypp"
+            {
+	      (yyval.formula_attr) = parsed_arena.make< ::Implies>((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
+	    }
+#line 1214 "parser/parser.cpp"
+    break;
+
+  case 11: /* imp_formula: or_formula  */
+#line 115 "parser/parser.ypp"
+            {
+	      (yyval.formula_attr) = (yyvsp[0].formula_attr);
+	    }
+#line 1222 "parser/parser.cpp"
+    break;
+
+  case 12: /* or_formula: or_formula OR and_formula  */
+#line 121 "parser/parser.ypp"
            {
-	     (yyval.formula_attr) = new ::Or((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
+	     (yyval.formula_attr) = parsed_arena.make< ::Or>((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
 	   }
-#line 1149 "parser/parser.cpp"
+#line 1230 "parser/parser.cpp"
     break;
 
-  case 9: /* or_formula: and_formula  */
-#line 81 "parser/parser.ypp"
+  case 13: /* or_formula: and_formula  */
+#line 125 "parser/parser.ypp"
            {
 	     (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	   }
-#line 1157 "parser/parser.cpp"
+#line 1238 "parser/parser.cpp"
     break;
 
-  case 10: /* and_formula: and_formula AND unary_formula  */
-#line 87 "parser/parser.ypp"
+  case 14: /* and_formula: and_formula AND unary_formula  */
+#line 131 "parser/parser.ypp"
             {
-	      (yyval.formula_attr) = new ::And((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
+	      (yyval.formula_attr) = parsed_arena.make< ::And>((yyvsp[-2].formula_attr), (yyvsp[0].formula_attr));
 	    }
-#line 1165 "parser/parser.cpp"
+#line 1246 "parser/parser.cpp"
     break;
 
-  case 11: /* and_formula: unary_formula  */
-#line 91 "parser/parser.ypp"
+  case 15: /* and_formula: unary_formula  */
+#line 135 "parser/parser.ypp"
             {
 	      (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	    }
-#line 1173 "parser/parser.cpp"
+#line 1254 "parser/parser.cpp"
     break;
 
-  case 12: /* unary_formula: NOT unary_formula  */
-#line 97 "parser/parser.ypp"
+  case 16: /* unary_formula: NOT unary_formula  */
+#line 141 "parser/parser.ypp"
               {
-	       (yyval.formula_attr) = new ::Not((yyvsp[0].formula_attr));
+	       (yyval.formula_attr) = parsed_arena.make< ::Not>((yyvsp[0].formula_attr));
 	      }
-#line 1181 "parser/parser.cpp"
+#line 1262 "parser/parser.cpp"
     break;
 
-  case 13: /* unary_formula: sub_formula  */
-#line 101 "parser/parser.ypp"
+  case 17: /* unary_formula: sub_formula  */
+#line 145 "parser/parser.ypp"
               {
 	       (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	      }
-#line 1189 "parser/parser.cpp"
+#line 1270 "parser/parser.cpp"
     break;
 
-  case 14: /* sub_formula: atomic_formula  */
-#line 107 "parser/parser.ypp"
+  case 18: /* sub_formula: atomic_formula  */
+#line 151 "parser/parser.ypp"
             {
 	      (yyval.formula_attr) = (yyvsp[0].formula_attr);
 	    }
-#line 1197 "parser/parser.cpp"
+#line 1278 "parser/parser.cpp"
     break;
 
-  case 15: /* sub_formula: '(' formula ')'  */
-#line 111 "parser/parser.ypp"
+  case 19: /* sub_formula: '(' formula ')'  */
+#line 155 "parser/parser.ypp"
             {
 	      (yyval.formula_attr) = (yyvsp[-1].formula_attr);
 	    }
-#line 1205 "parser/parser.cpp"
+#line 1286 "parser/parser.cpp"
     break;
 
-  case 16: /* atomic_formula: SYMBOL  */
-#line 117 "parser/parser.ypp"
+  case 20: /* atomic_formula: SYMBOL  */
+#line 161 "parser/parser.ypp"
                {
-	         (yyval.formula_attr) = new ::Variable(*(yyvsp[0].str_attr));
+	         (yyval.formula_attr) = parsed_arena.make< ::Variable>(*(yyvsp[0].str_attr));
 	         delete (yyvsp[0].str_attr);
 	       }
-#line 1214 "parser/parser.cpp"
+#line 1295 "parser/parser.cpp"
+    break;
+
+  case 21: /* atomic_formula: TRUE  */
+#line 166 "parser/parser.ypp"
+               {
+	         (yyval.formula_attr) = parsed_arena.make< ::Constant>(true);
+	       }
+#line 1303 "parser/parser.cpp"
+    break;
+
+  case 22: /* atomic_formula: FALSE  */
+#line 170 "parser/parser.ypp"
+               {
+	         (yyval.formula_attr) = parsed_arena.make< ::Constant>(false);
+	       }
+#line 1311 "parser/parser.cpp"
+    break;
+
+  case 23: /* atomic_formula: ATLEAST '(' NUMBER ',' formula_list ')'  */
+#line 174 "parser/parser.ypp"
+               {
+	         (yyval.formula_attr) = at_least((yyvsp[-3].int_attr), (yyvsp[-1].list_attr));
+	       }
+#line 1319 "parser/parser.cpp"
+    break;
+
+  case 24: /* atomic_formula: ATMOST '(' NUMBER ',' formula_list ')'  */
+#line 178 "parser/parser.ypp"
+               {
+	         (yyval.formula_attr) = parsed_arena.make< ::Not>(at_least(uint64_t((yyvsp[-3].int_attr)) + 1, (yyvsp[-1].list_attr)));
+	       }
+#line 1327 "parser/parser.cpp"
+    break;
+
+  case 25: /* formula_list: formula_list ',' formula  */
+#line 184 "parser/parser.ypp"
+             {
+	       (yyvsp[-2].list_attr)->push_back((yyvsp[0].formula_attr));
+	       (yyval.list_attr) = (yyvsp[-2].list_attr);
+	     }
+#line 1336 "parser/parser.cpp"
+    break;
+
+  case 26: /* formula_list: formula  */
+#line 189 "parser/parser.ypp"
+             {
+	       (yyval.list_attr) = new std::vector< ::Formula*>{(yyvsp[0].formula_attr)};
+	     }
+#line 1344 "parser/parser.cpp"
     break;
 
 
-#line 1218 "parser/parser.cpp"
+#line 1348 "parser/parser.cpp"
 
       default: break;
     }
@@ -1407,5 +1537,5 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 123 "parser/parser.ypp"
+#line 194 "parser/parser.ypp"
 
@@ -59,7 +59,12 @@ extern int yydebug;
     AND = 260,                     /* AND  */
     OR = 261,                      /* OR  */
     IMP = 262,                     /* IMP  */
-    IFF = 263                      /* IFF  */
+    IFF = 263,                     /* IFF  */
+    TRUE = 264,                    /* TRUE  */
+    FALSE = 265,                   /* FALSE  */
+    ATLEAST = 266,                 /* ATLEAST  */
+    ATMOST = 267,                  /* ATMOST  */
+    NUMBER = 268                   /* NUMBER  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
@@ -68,12 +73,14 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 37 "parser/parser.ypp"
+#line 60 "parser/parser.ypp"
 
   std::string * str_attr;
   ::Formula * formula_attr;
+  uint32_t int_attr;
+  std::vector< ::Formula*> * list_attr;
 
-#line 77 "parser/parser.hpp"
+#line 84 "parser/parser.hpp"
 
 };
 typedef union YYSTYPE YYSTYPE;
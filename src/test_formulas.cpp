@@ -1,59 +1,128 @@
 #include "formula.hpp"
 #include "truthtable.hpp"
 #include "dagformula.hpp"
+#include "dagsolver.hpp"
+#include "arena.hpp"
+#include "normalize.hpp"
+#include "cardinality.hpp"
+#include "gates.hpp"
+#include "jit.hpp"
 #include <chrono>
 #include <iomanip>
 #include <map>
+#include <random>
+#include <sstream>
 #include <string>
 #include <vector>
 
 namespace {
+// Every test formula is made here and released together at the end of the run.
+Arena arena;
+
 // Helper to avoid shared ownership; each call returns a fresh variable node.
-Variable* v(const std::string& name) { return new Variable(name); }
+Variable* v(const std::string& name) { return arena.make<Variable>(name); }
 
 Formula* disj3(Formula* a, Formula* b, Formula* c) {
-	return new Or(new Or(a, b), c);
+	return arena.make<Or>(arena.make<Or>(a, b), c);
 }
 
 Formula* conj3(Formula* a, Formula* b, Formula* c) {
-	return new And(new And(a, b), c);
+	return arena.make<And>(arena.make<And>(a, b), c);
 }
 
 Formula* and_all(const std::vector<Formula*>& parts) {
 	if (parts.empty()) return nullptr;
 	Formula* cur = parts[0];
 	for (size_t i = 1; i < parts.size(); ++i) {
-		cur = new And(cur, parts[i]);
+		cur = arena.make<And>(cur, parts[i]);
 	}
 	return cur;
 }
 
+Formula* at_least(uint32_t bound, const std::vector<Formula*>& parts) {
+	return make_at_least(arena, bound, parts.data(), parts.size());
+}
+
 Formula* cnf_abc() {
 	return conj3(
-		new Or(v("A"), v("B")),
-		new Or(new Not(v("A")), v("C")),
-		new Or(new Not(v("B")), v("C"))
+		arena.make<Or>(v("A"), v("B")),
+		arena.make<Or>(arena.make<Not>(v("A")), v("C")),
+		arena.make<Or>(arena.make<Not>(v("B")), v("C"))
 	);
 }
 
 Formula* cnf_def() {
 	return conj3(
-		new Or(v("D"), v("E")),
-		new Or(new Not(v("D")), v("F")),
-		new Or(new Not(v("E")), v("F"))
+		arena.make<Or>(v("D"), v("E")),
+		arena.make<Or>(arena.make<Not>(v("D")), v("F")),
+		arena.make<Or>(arena.make<Not>(v("E")), v("F"))
 	);
 }
 
 Formula* implies_chain(const std::string& a, const std::string& b, const std::string& c) {
-	return new And(new Implies(v(a), v(b)), new Implies(v(b), v(c)));
+	return arena.make<And>(arena.make<Implies>(v(a), v(b)), arena.make<Implies>(v(b), v(c)));
 }
 
+// A SAT answer only counts if the model found by the search satisfies f.
+// The DAG is reused across tests, so later builds run in its existing arrays.
+DAG dag;
+
 bool sat_dag(Formula* f) {
-	std::map<std::string, DAGNode*> node_map;
-	DAGNode* dag = build_dag(f, node_map, nullptr);
-	return dag->label(TruthValue::TRUE, 0, TruthValueChangeReason::TRIGGER);
+	dag.clear();
+	NodeId root = build_dag(f, dag);
+	DAGSolver solver(dag, root);
+	return solver.solve() && f->solve(solver.model());
+}
+
+// The same search on the sign-normal form of f; the model must satisfy f itself.
+bool sat_dag_normalized(Formula*& f) {
+	Formula* normal = normalize(f, arena);
+	dag.clear();
+	NodeId root = build_dag(normal, dag);
+	DAGSolver solver(dag, root);
+	return solver.solve() && f->solve(solver.model());
+}
+
+// The same search after pairwise at-most-one encodings collapse into cardinality nodes.
+bool sat_dag_cardinality(Formula*& f) {
+	dag.clear();
+	NodeId root = build_dag(f, dag);
+	DAG collapsed;
+	CardinalityReport report;
+	root = collapse_at_most_one(dag, root, collapsed, report);
+	DAGSolver solver(collapsed, root);
+	return solver.solve() && f->solve(solver.model());
+}
+
+// A second solve() on the same solver must give the same answer, also when
+// the first one ended in a conflict after learning.
+bool sat_dag_twice(Formula*& f) {
+	dag.clear();
+	NodeId root = build_dag(f, dag);
+	DAGSolver solver(dag, root);
+	bool first = solver.solve();
+	if (solver.solve() != first) {
+		return !first;  // a changed answer counts as a wrong one
+	}
+	return first && f->solve(solver.model());
 }
 
+// Other complete engines, each checked against the expected result of every test.
+struct Engine {
+	const char* name;
+	bool (*sat)(Formula*&);
+};
+
+const Engine engines[] = {
+	{"pruned truthtable", sat_truthtable_pruned},
+	{"bitsliced", sat_truthtable_bitsliced},
+	{"graycode", sat_truthtable_graycode},
+	{"aig", sat_truthtable_aig},
+	{"normalized dag", sat_dag_normalized},
+	{"cardinality dag", sat_dag_cardinality},
+	{"dag solved twice", sat_dag_twice},
+};
+
 struct TestCase {
 	std::string label;
 	Formula* formula;
@@ -65,6 +134,7 @@ struct TestResult {
 	bool dag_res;
 	double tt_secs;
 	double dag_secs;
+	int engines_wrong;
 };
 
 TestResult test_formula(Formula* f, const std::string& label, bool expected_sat) {
@@ -87,152 +157,328 @@ TestResult test_formula(Formula* f, const std::string& label, bool expected_sat)
 	std::cout << "- truthtable time executed: " << std::fixed << std::setprecision(6) << tt_secs << " seconds" << std::endl;
 	std::cout << "- dag result: " << (dag_res ? "SAT" : "UNSAT") << std::endl;
 	std::cout << "- dag time executed: " << std::fixed << std::setprecision(6) << dag_secs << " seconds" << std::endl;
+
+	int engines_wrong = 0;
+	for (const auto& engine : engines) {
+		auto start = std::chrono::high_resolution_clock::now();
+		bool res = engine.sat(f);
+		auto end = std::chrono::high_resolution_clock::now();
+		double secs = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+		std::cout << "- " << engine.name << " result: " << (res ? "SAT" : "UNSAT") << " in " << std::fixed << std::setprecision(6) << secs << " seconds" << std::endl;
+		if (res != expected_sat) {
+			++engines_wrong;
+		}
+	}
+
+	// the native code of the JIT must compute what the interpreter computes
+	GateList list = compile_gates(f);
+	GateEvaluator interpreter(list);
+	JitEvaluator jit(list);
+	std::mt19937_64 random(1);
+	bool jit_agrees = true;
+	for (int round = 0; round < 16; ++round) {
+		for (size_t i = 0; i < list.inputs.size(); ++i) {
+			interpreter.slot[i] = jit.slot[i] = random();
+		}
+		if (jit.run() != interpreter.run()) {
+			jit_agrees = false;
+		}
+	}
+	std::cout << "- jit " << (jit.native() ? "native" : "interpreted") << ", agrees with interpreter: " << (jit_agrees ? "yes" : "no") << std::endl;
+	if (!jit_agrees) {
+		++engines_wrong;
+	}
 	std::cout << std::endl;
 
-	return {tt_res, dag_res, tt_secs, dag_secs};
+	return {tt_res, dag_res, tt_secs, dag_secs, engines_wrong};
+}
+// sat_bitsliced only splits the search among threads on lists with at least
+// 12 counted inputs, more than any test formula has, so run it on 4 workers
+// on a formula with a single model and on one with none. Both take the
+// parity of 22 variables; with all of them TRUE it is FALSE.
+int test_parallel_bitsliced() {
+	int wrong = 0;
+	for (bool satisfiable : {true, false}) {
+		std::vector<Formula*> parts;
+		Formula* parity = v("w0");
+		for (int i = 1; i < 22; ++i) {
+			parity = arena.make<Xor>(parity, v("w" + std::to_string(i)));
+		}
+		for (int i = satisfiable ? 1 : 0; i < 22; ++i) {
+			parts.push_back(v("w" + std::to_string(i)));
+		}
+		parts.push_back(parity);
+		Formula* f = and_all(parts);
+
+		GateList list = compile_gates(f);
+		Valuation model(symbol_table.size());
+		bool res = sat_bitsliced(list, model, 4);
+		std::cout << "parallel bitsliced search, expected: " << (satisfiable ? "SAT" : "UNSAT")
+			<< ", result: " << (res ? "SAT" : "UNSAT") << std::endl;
+		if (res != satisfiable || (res && !f->solve(model))) {
+			++wrong;
+		}
+	}
+	std::cout << std::endl;
+	return wrong;
+}
+// The formula operations walk the tree with an explicit stack, so a formula a
+// million levels deep must not overflow the thread stack: a million NOTs over p
+// (which is p again) and a left-deep AND chain of a million operands.
+int test_deep_formula() {
+	const int depth = 1000000;
+	Formula* nots = v("p");
+	for (int i = 0; i < depth; ++i) {
+		nots = arena.make<Not>(nots);
+	}
+	Formula* chain = v("q");
+	for (int i = 1; i < depth; ++i) {
+		chain = arena.make<And>(chain, i % 2 ? v("p") : v("q"));
+	}
+	Formula* f = arena.make<And>(nots, chain);
+
+	std::ostringstream printed;
+	std::streambuf* out = std::cout.rdbuf(printed.rdbuf());
+	f->print();
+	std::cout.rdbuf(out);
+	std::string text = printed.str();
+	size_t negations = 0;
+	for (size_t at = text.find("¬"); at != std::string::npos; at = text.find("¬", at + 1)) {
+		++negations;
+	}
+
+	auto vars = f->get_vars();
+	dag.clear();
+	NodeId root = build_dag(f, dag);
+	DAGSolver solver(dag, root);
+	bool res = solver.solve() && f->solve(solver.model());
+	bool ok = res && negations == size_t(depth) && vars.size() == 2;
+	std::cout << "formula " << depth << " levels deep: " << (res ? "SAT" : "UNSAT") << ", " << negations
+		<< " negations printed, " << vars.size() << " variables, dag nodes: " << dag.size() << std::endl << std::endl;
+	return ok ? 0 : 1;
 }
 } // namespace
 
 void test_formulas() {
 	std::vector<TestCase> tests;
 
-	tests.push_back({"A or not A", new Or(v("A"), new Not(v("A"))), true});
-	tests.push_back({"p and not p", new And(v("p"), new Not(v("p"))), false});
-	tests.push_back({"(p or q) and not p and not q", new And(new And(new Or(v("p"), v("q")), new Not(v("p"))), new Not(v("q"))), false});
-	tests.push_back({"not (p or not p)", new Not(new Or(v("p"), new Not(v("p")))), false});
-	tests.push_back({"(p => q) and p and not q", new And(new And(new Implies(v("p"), v("q")), v("p")), new Not(v("q"))), false});
-	tests.push_back({"(p <=> q) and p and not q", new And(new And(new Eq(v("p"), v("q")), v("p")), new Not(v("q"))), false});
-	tests.push_back({"A implies B", new Implies(v("A"), v("B")), true});
-	tests.push_back({"(X and Y) implies X", new Implies(new And(v("X"), v("Y")), v("X")), true});
-	tests.push_back({"(not p => q) <=> (p or q)", new Eq(new Implies(new Not(v("p")), v("q")), new Or(v("p"), v("q"))), true});
+	tests.push_back({"A or not A", arena.make<Or>(v("A"), arena.make<Not>(v("A"))), true});
+	tests.push_back({"p and not p", arena.make<And>(v("p"), arena.make<Not>(v("p"))), false});
+	tests.push_back({"(p or q) and not p and not q", arena.make<And>(arena.make<And>(arena.make<Or>(v("p"), v("q")), arena.make<Not>(v("p"))), arena.make<Not>(v("q"))), false});
+	tests.push_back({"not (p or not p)", arena.make<Not>(arena.make<Or>(v("p"), arena.make<Not>(v("p")))), false});
+	tests.push_back({"(p => q) and p and not q", arena.make<And>(arena.make<And>(arena.make<Implies>(v("p"), v("q")), v("p")), arena.make<Not>(v("q"))), false});
+	tests.push_back({"(p <=> q) and p and not q", arena.make<And>(arena.make<And>(arena.make<Eq>(v("p"), v("q")), v("p")), arena.make<Not>(v("q"))), false});
+	tests.push_back({"(not p and not (p and q)) and (r and (s and (t and q)))", arena.make<And>(arena.make<And>(arena.make<Not>(v("p")), arena.make<Not>(arena.make<And>(v("p"), v("q")))), arena.make<And>(v("r"), arena.make<And>(v("s"), arena.make<And>(v("t"), v("q"))))), true});
+	tests.push_back({"(p or q) and (p or not q) and (not p or q) and (not p or not q)", and_all({
+		arena.make<Or>(v("p"), v("q")),
+		arena.make<Or>(v("p"), arena.make<Not>(v("q"))),
+		arena.make<Or>(arena.make<Not>(v("p")), v("q")),
+		arena.make<Or>(arena.make<Not>(v("p")), arena.make<Not>(v("q")))
+	}), false});
+	tests.push_back({"A implies B", arena.make<Implies>(v("A"), v("B")), true});
+	tests.push_back({"(X and Y) implies X", arena.make<Implies>(arena.make<And>(v("X"), v("Y")), v("X")), true});
+	tests.push_back({"(not p => q) <=> (p or q)", arena.make<Eq>(arena.make<Implies>(arena.make<Not>(v("p")), v("q")), arena.make<Or>(v("p"), v("q"))), true});
 	tests.push_back({"(A or B) and (not A or C) and (not B or C)", cnf_abc(), true});
-	tests.push_back({"(P=>Q) and (Q=>R) and (not R)", new And(implies_chain("P", "Q", "R"), new Not(v("R"))), true});
-	tests.push_back({"(X<=>Y) and (Y=>Z) and (not Z or X)", new And(new And(new Eq(v("X"), v("Y")), new Implies(v("Y"), v("Z"))), new Or(new Not(v("Z")), v("X"))), true});
-	tests.push_back({"(A or B or C) and (not A or not B or C) and (not C or A)", conj3(disj3(v("A"), v("B"), v("C")), disj3(new Not(v("A")), new Not(v("B")), v("C")), new Or(new Not(v("C")), v("A"))), true});
-	tests.push_back({"((P&Q)=>(R&S)) and (not R or not S)", new And(new Implies(new And(v("P"), v("Q")), new And(v("R"), v("S"))), new Or(new Not(v("R")), new Not(v("S")))), true});
+	tests.push_back({"(P=>Q) and (Q=>R) and (not R)", arena.make<And>(implies_chain("P", "Q", "R"), arena.make<Not>(v("R"))), true});
+	tests.push_back({"(X<=>Y) and (Y=>Z) and (not Z or X)", arena.make<And>(arena.make<And>(arena.make<Eq>(v("X"), v("Y")), arena.make<Implies>(v("Y"), v("Z"))), arena.make<Or>(arena.make<Not>(v("Z")), v("X"))), true});
+	tests.push_back({"(A or B or C) and (not A or not B or C) and (not C or A)", conj3(disj3(v("A"), v("B"), v("C")), disj3(arena.make<Not>(v("A")), arena.make<Not>(v("B")), v("C")), arena.make<Or>(arena.make<Not>(v("C")), v("A"))), true});
+	tests.push_back({"((P&Q)=>(R&S)) and (not R or not S)", arena.make<And>(arena.make<Implies>(arena.make<And>(v("P"), v("Q")), arena.make<And>(v("R"), v("S"))), arena.make<Or>(arena.make<Not>(v("R")), arena.make<Not>(v("S")))), true});
 
-	tests.push_back({"((A or B) and (not A or C) and (not B or C)) and ((D or E) and (not D or F) and (not E or F))", new And(cnf_abc(), cnf_def()), true});
+	tests.push_back({"((A or B) and (not A or C) and (not B or C)) and ((D or E) and (not D or F) and (not E or F))", arena.make<And>(cnf_abc(), cnf_def()), true});
 
-	tests.push_back({"(P=>Q & Q=>R & not R) or (S=>T & T=>U & not U)", new Or(
-		new And(implies_chain("P", "Q", "R"), new Not(v("R"))),
-		new And(implies_chain("S", "T", "U"), new Not(v("U")))
+	tests.push_back({"(P=>Q & Q=>R & not R) or (S=>T & T=>U & not U)", arena.make<Or>(
+		arena.make<And>(implies_chain("P", "Q", "R"), arena.make<Not>(v("R"))),
+		arena.make<And>(implies_chain("S", "T", "U"), arena.make<Not>(v("U")))
 	), true});
 
-	tests.push_back({"(((A or B) and (not A or C)) and ((B or D) and (not B or E))) => (F and G)", new Implies(
-		new And(new And(new Or(v("A"), v("B")), new Or(new Not(v("A")), v("C"))), new And(new Or(v("B"), v("D")), new Or(new Not(v("B")), v("E")))),
-		new And(v("F"), v("G"))
+	tests.push_back({"(((A or B) and (not A or C)) and ((B or D) and (not B or E))) => (F and G)", arena.make<Implies>(
+		arena.make<And>(arena.make<And>(arena.make<Or>(v("A"), v("B")), arena.make<Or>(arena.make<Not>(v("A")), v("C"))), arena.make<And>(arena.make<Or>(v("B"), v("D")), arena.make<Or>(arena.make<Not>(v("B")), v("E")))),
+		arena.make<And>(v("F"), v("G"))
 	), true});
 
-	tests.push_back({"(X<=>Y) & (Y=>Z) & (not Z or X) & (U=>V) & (V=>W) & (not W)", new And(
-		new And(new And(new Eq(v("X"), v("Y")), new Implies(v("Y"), v("Z"))), new Or(new Not(v("Z")), v("X"))),
-		new And(new And(new Implies(v("U"), v("V")), new Implies(v("V"), v("W"))), new Not(v("W")))
+	tests.push_back({"(X<=>Y) & (Y=>Z) & (not Z or X) & (U=>V) & (V=>W) & (not W)", arena.make<And>(
+		arena.make<And>(arena.make<And>(arena.make<Eq>(v("X"), v("Y")), arena.make<Implies>(v("Y"), v("Z"))), arena.make<Or>(arena.make<Not>(v("Z")), v("X"))),
+		arena.make<And>(arena.make<And>(arena.make<Implies>(v("U"), v("V")), arena.make<Implies>(v("V"), v("W"))), arena.make<Not>(v("W")))
 	), true});
 
 	tests.push_back({"((A or B or C) and (not A or not B or C) and (not C or A) and (D or E) and (not D or F) and (not E or F)) or G",
-		new Or(
+		arena.make<Or>(
 			and_all({
 				disj3(v("A"), v("B"), v("C")),
-				disj3(new Not(v("A")), new Not(v("B")), v("C")),
-				new Or(new Not(v("C")), v("A")),
-				new Or(v("D"), v("E")),
-				new Or(new Not(v("D")), v("F")),
-				new Or(new Not(v("E")), v("F"))
+				disj3(arena.make<Not>(v("A")), arena.make<Not>(v("B")), v("C")),
+				arena.make<Or>(arena.make<Not>(v("C")), v("A")),
+				arena.make<Or>(v("D"), v("E")),
+				arena.make<Or>(arena.make<Not>(v("D")), v("F")),
+				arena.make<Or>(arena.make<Not>(v("E")), v("F"))
 			}),
 			v("G")
 		),
 		true});
 
 	tests.push_back({"((A or B) and (not A or C) and (not B or C)) and ((D or E) and (not D or F) and (not E or F)) and ((A or B) and (not A or C) and (not B or C))",
-		new And(new And(cnf_abc(), cnf_def()), cnf_abc()),
+		arena.make<And>(arena.make<And>(cnf_abc(), cnf_def()), cnf_abc()),
 		true});
 
-	tests.push_back({"double UNSAT disjunction", new Or(
-		new Or(new And(implies_chain("P", "Q", "R"), new Not(v("R"))), new And(implies_chain("S", "T", "U"), new Not(v("U")))),
-		new And(implies_chain("P", "Q", "R"), new Not(v("R")))
+	tests.push_back({"double UNSAT disjunction", arena.make<Or>(
+		arena.make<Or>(arena.make<And>(implies_chain("P", "Q", "R"), arena.make<Not>(v("R"))), arena.make<And>(implies_chain("S", "T", "U"), arena.make<Not>(v("U")))),
+		arena.make<And>(implies_chain("P", "Q", "R"), arena.make<Not>(v("R")))
 	), true});
 
 	tests.push_back({"(((A or B) and (not A or C)) and ((B or D) and (not B or E)) and ((A or B) and (not A or C))) => (F and G)",
-		new Implies(
+		arena.make<Implies>(
 			and_all({
-				new And(new Or(v("A"), v("B")), new Or(new Not(v("A")), v("C"))),
-				new And(new Or(v("B"), v("D")), new Or(new Not(v("B")), v("E"))),
-				new And(new Or(v("A"), v("B")), new Or(new Not(v("A")), v("C")))
+				arena.make<And>(arena.make<Or>(v("A"), v("B")), arena.make<Or>(arena.make<Not>(v("A")), v("C"))),
+				arena.make<And>(arena.make<Or>(v("B"), v("D")), arena.make<Or>(arena.make<Not>(v("B")), v("E"))),
+				arena.make<And>(arena.make<Or>(v("A"), v("B")), arena.make<Or>(arena.make<Not>(v("A")), v("C")))
 			}),
-			new And(v("F"), v("G"))
+			arena.make<And>(v("F"), v("G"))
 		),
 		true});
 
 	tests.push_back({"(X<=>Y) & (Y=>Z) & (not Z or X) & (U=>V) & (V=>W) & (not W) & (X<=>Y) & (Y=>Z)",
 		and_all({
-			new Eq(v("X"), v("Y")),
-			new Implies(v("Y"), v("Z")),
-			new Or(new Not(v("Z")), v("X")),
-			new Implies(v("U"), v("V")),
-			new Implies(v("V"), v("W")),
-			new Not(v("W")),
-			new Eq(v("X"), v("Y")),
-			new Implies(v("Y"), v("Z"))
+			arena.make<Eq>(v("X"), v("Y")),
+			arena.make<Implies>(v("Y"), v("Z")),
+			arena.make<Or>(arena.make<Not>(v("Z")), v("X")),
+			arena.make<Implies>(v("U"), v("V")),
+			arena.make<Implies>(v("V"), v("W")),
+			arena.make<Not>(v("W")),
+			arena.make<Eq>(v("X"), v("Y")),
+			arena.make<Implies>(v("Y"), v("Z"))
 		}),
 		true});
 
 	tests.push_back({"((A or B or C) and (not A or not B or C) and (not C or A) and (D or E) and (not D or F) and (not E or F)) or ((A or B or C) and (not A or not B or C))",
-		new Or(
+		arena.make<Or>(
 			and_all({
 				disj3(v("A"), v("B"), v("C")),
-				disj3(new Not(v("A")), new Not(v("B")), v("C")),
-				new Or(new Not(v("C")), v("A")),
-				new Or(v("D"), v("E")),
-				new Or(new Not(v("D")), v("F")),
-				new Or(new Not(v("E")), v("F"))
+				disj3(arena.make<Not>(v("A")), arena.make<Not>(v("B")), v("C")),
+				arena.make<Or>(arena.make<Not>(v("C")), v("A")),
+				arena.make<Or>(v("D"), v("E")),
+				arena.make<Or>(arena.make<Not>(v("D")), v("F")),
+				arena.make<Or>(arena.make<Not>(v("E")), v("F"))
 			}),
 			and_all({
 				disj3(v("A"), v("B"), v("C")),
-				disj3(new Not(v("A")), new Not(v("B")), v("C"))
+				disj3(arena.make<Not>(v("A")), arena.make<Not>(v("B")), v("C"))
 			})
 		),
 		true});
 
 	tests.push_back({"((p and q) => r) and ((p and q) => s) and ((p and q) => t) and (p and q)",
 		and_all({
-			new Implies(new And(v("p"), v("q")), v("r")),
-			new Implies(new And(v("p"), v("q")), v("s")),
-			new Implies(new And(v("p"), v("q")), v("t")),
-			new And(v("p"), v("q"))
+			arena.make<Implies>(arena.make<And>(v("p"), v("q")), v("r")),
+			arena.make<Implies>(arena.make<And>(v("p"), v("q")), v("s")),
+			arena.make<Implies>(arena.make<And>(v("p"), v("q")), v("t")),
+			arena.make<And>(v("p"), v("q"))
 		}),
 		true});
 
 	tests.push_back({"(a => b) and (b => c) and (c => d) and (d => e) and (e => not a) and a",
 		and_all({
-			new Implies(v("a"), v("b")),
-			new Implies(v("b"), v("c")),
-			new Implies(v("c"), v("d")),
-			new Implies(v("d"), v("e")),
-			new Implies(v("e"), new Not(v("a"))),
+			arena.make<Implies>(v("a"), v("b")),
+			arena.make<Implies>(v("b"), v("c")),
+			arena.make<Implies>(v("c"), v("d")),
+			arena.make<Implies>(v("d"), v("e")),
+			arena.make<Implies>(v("e"), arena.make<Not>(v("a"))),
 			v("a")
 		}),
 		false});
 
-	auto triple = [](){ return new And(new And(v("x1"), v("x2")), v("x3")); };
-	Formula* repeated_triple = new Or(new Or(new Or(new Or(triple(), triple()), triple()), triple()), triple());
+	auto triple = [](){ return arena.make<And>(arena.make<And>(v("x1"), v("x2")), v("x3")); };
+	Formula* repeated_triple = arena.make<Or>(arena.make<Or>(arena.make<Or>(arena.make<Or>(triple(), triple()), triple()), triple()), triple());
 	tests.push_back({"(x1 and x2 and x3) repeated disjunction", repeated_triple, true});
 
 	tests.push_back({"(p or q) and (p or r) and (p or s) and (p or t) and not p",
 		and_all({
-			new Or(v("p"), v("q")),
-			new Or(v("p"), v("r")),
-			new Or(v("p"), v("s")),
-			new Or(v("p"), v("t")),
-			new Not(v("p"))
+			arena.make<Or>(v("p"), v("q")),
+			arena.make<Or>(v("p"), v("r")),
+			arena.make<Or>(v("p"), v("s")),
+			arena.make<Or>(v("p"), v("t")),
+			arena.make<Not>(v("p"))
 		}),
 		true});
 
 
+	tests.push_back({"(p and q and not p) or (r and s and not r)", arena.make<Or>(
+		conj3(v("p"), v("q"), arena.make<Not>(v("p"))),
+		conj3(v("r"), v("s"), arena.make<Not>(v("r")))
+	), false});
+
+	tests.push_back({"(p or q or p) and (q or not q) and not p", conj3(
+		disj3(v("p"), v("q"), v("p")),
+		arena.make<Or>(v("q"), arena.make<Not>(v("q"))),
+		arena.make<Not>(v("p"))
+	), true});
+
+	tests.push_back({"not not p and (p => q) and not (not p or q)", conj3(
+		arena.make<Not>(arena.make<Not>(v("p"))),
+		arena.make<Implies>(v("p"), v("q")),
+		arena.make<Not>(arena.make<Or>(arena.make<Not>(v("p")), v("q")))
+	), false});
+
+	tests.push_back({"(p or false) and (true => not p)", arena.make<And>(
+		arena.make<Or>(v("p"), arena.make<Constant>(false)),
+		arena.make<Implies>(arena.make<Constant>(true), arena.make<Not>(v("p")))
+	), false});
+
+	tests.push_back({"(p and true) or (false and q)", arena.make<Or>(
+		arena.make<And>(v("p"), arena.make<Constant>(true)),
+		arena.make<And>(arena.make<Constant>(false), v("q"))
+	), true});
+
+	tests.push_back({"(p xor q) and (p <=> q)", arena.make<And>(
+		arena.make<Xor>(v("p"), v("q")),
+		arena.make<Eq>(v("p"), v("q"))
+	), false});
+
+	tests.push_back({"(p ? q : r) and not q and not r", conj3(
+		arena.make<Ite>(v("p"), v("q"), v("r")),
+		arena.make<Not>(v("q")),
+		arena.make<Not>(v("r"))
+	), false});
+
+	tests.push_back({"(p ? q xor r : q) and (not p => r)", arena.make<And>(
+		arena.make<Ite>(v("p"), arena.make<Xor>(v("q"), v("r")), v("q")),
+		arena.make<Implies>(arena.make<Not>(v("p")), v("r"))
+	), true});
+
+	tests.push_back({"((p <=> q) <=> r) xor ((r <=> p) <=> q)", arena.make<Xor>(
+		arena.make<Eq>(arena.make<Eq>(v("p"), v("q")), v("r")),
+		arena.make<Eq>(arena.make<Eq>(v("r"), v("p")), v("q"))
+	), false});
+
+	tests.push_back({"((p xor q) xor r) and (p <=> q) and not (r xor s)", conj3(
+		arena.make<Xor>(arena.make<Xor>(v("p"), v("q")), v("r")),
+		arena.make<Eq>(v("p"), v("q")),
+		arena.make<Not>(arena.make<Xor>(v("r"), v("s")))
+	), true});
+
+	tests.push_back({"atmost(1, p, q, r) and p and (q or r)", conj3(
+		arena.make<Not>(at_least(2, {v("p"), v("q"), v("r")})),
+		v("p"),
+		arena.make<Or>(v("q"), v("r"))
+	), false});
+
+	tests.push_back({"not (p and q) and (not p or not r) and (q => not r) and atleast(2, p, q, r, s)", and_all({
+		arena.make<Not>(arena.make<And>(v("p"), v("q"))),
+		arena.make<Or>(arena.make<Not>(v("p")), arena.make<Not>(v("r"))),
+		arena.make<Implies>(v("q"), arena.make<Not>(v("r"))),
+		at_least(2, {v("p"), v("q"), v("r"), v("s")})
+	}), true});
+
+	tests.push_back({"not (p and q) and (q and (p <=> q))", arena.make<And>(
+		arena.make<Not>(arena.make<And>(v("p"), v("q"))),
+		arena.make<And>(v("q"), arena.make<Eq>(v("p"), v("q")))
+	), false});
+
 	int tt_correct = 0;
 	int tt_incorrect = 0;
 	int dag_correct = 0;
 	int dag_incorrect = 0;
 	int dag_faster = 0;
 	int dag_slower = 0;
+	int engines_wrong = 0;
 
 	for (const auto& t : tests) {
 		TestResult r = test_formula(t.formula, t.label, t.expected_sat);
@@ -251,10 +497,16 @@ void test_formulas() {
 		} else if (r.dag_secs > r.tt_secs) {
 			++dag_slower;
 		}
+		engines_wrong += r.engines_wrong;
 	}
+	engines_wrong += test_parallel_bitsliced();
+	engines_wrong += test_deep_formula();
 
 	std::cout << "Summary:" << std::endl;
 	std::cout << "- truthtable correct: " << tt_correct << " | incorrect: " << tt_incorrect << std::endl;
 	std::cout << "- dag correct: " << dag_correct << " | incorrect: " << dag_incorrect << std::endl;
+	std::cout << "- other engines wrong: " << engines_wrong << std::endl;
 	std::cout << "- dag faster: " << dag_faster << " | dag slower: " << dag_slower << std::endl;
+	std::cout << "- formula arena: " << arena.stats().objects << " nodes in " << arena.stats().bytes_reserved << " bytes" << std::endl;
+	arena.reset();
 }
\ No newline at end of file
@@ -1,39 +1,74 @@
 #include "formula.hpp"
+#include "gates.hpp"
+#include <thread>
 
-bool truthtable(Formula* &f, std::set<std::string> &vars, Valuation &v){
-    if(vars.size() == v.size()){
+// Try both values of vars[next], then of the variables after it; once all of
+// them are assigned, evaluate the formula tree itself.
+bool truthtable(const Formula* f, const std::vector<uint32_t>& vars, size_t next, Valuation& v){
+    if(next == vars.size()){
         return f->solve(v);
     }
-    
-    std::string current_var;
-    for(auto var:vars){
-        if(v.find(var) == v.end()){
-            current_var = var;
-            break;
-        }
+
+    v.set(vars[next], true);
+    if(truthtable(f, vars, next + 1, v)){
+        return true;
+    }
+
+    v.set(vars[next], false);
+    return truthtable(f, vars, next + 1, v);
+}
+
+// Evaluate f on the partial valuation first: a known result decides the whole
+// subtree, so a FALSE prunes it and a TRUE ends the search. Otherwise try both
+// values of the next input; inputs before next are assigned, the rest UNKNOWN.
+bool pruned_truthtable(KleeneEvaluator &e, size_t next){
+    auto value = e.run();
+    if(value != TruthValue::UNKNOWN){
+        return value == TruthValue::TRUE;
     }
 
-    v[current_var] = true;
-    auto sat = truthtable(f,vars,v);
-    if(sat){
-        v.erase(current_var);
+    e.assign(next, TruthValue::TRUE);
+    if(pruned_truthtable(e,next + 1)){
         return true;
     }
 
-    v[current_var] = false;
-    sat = truthtable(f,vars,v);
-    if(sat){
-        v.erase(current_var);
+    e.assign(next, TruthValue::FALSE);
+    if(pruned_truthtable(e,next + 1)){
         return true;
     }
 
-    v.erase(current_var);
+    e.assign(next, TruthValue::UNKNOWN);
     return false;
 }
 
 
 bool sat_truthtable(Formula* &f){
     auto vars = f->get_vars();
-    Valuation v;
-    return truthtable(f,vars,v);
-}
\ No newline at end of file
+    Valuation v(symbol_table.size());
+    return truthtable(f, vars, 0, v);
+}
+
+bool sat_truthtable_pruned(Formula* &f){
+    auto gates = compile_gates(f);
+    KleeneEvaluator e(gates);
+    return pruned_truthtable(e,0);
+}
+
+bool sat_truthtable_bitsliced(Formula* &f){
+    auto gates = compile_gates(f);
+    Valuation v(symbol_table.size());
+    return sat_bitsliced(gates, v, std::thread::hardware_concurrency()) && f->solve(v);
+}
+
+bool sat_truthtable_graycode(Formula* &f){
+    auto gates = compile_gates(f);
+    Valuation v(symbol_table.size());
+    return sat_graycode(gates, v) && f->solve(v);
+}
+
+bool sat_truthtable_aig(Formula* &f){
+    AIG aig;
+    auto gates = compile_gates(aig, build_aig(f, aig));
+    Valuation v(symbol_table.size());
+    return sat_bitsliced(gates, v, std::thread::hardware_concurrency()) && f->solve(v);
+}
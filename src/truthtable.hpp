@@ -2,6 +2,17 @@
 #define __TRUTH_TABLE__
 #include "formula.hpp"
 
+// The reference: every valuation of the variables of f in turn, evaluated on
+// the formula tree itself, so it shares no code with the DAG.
 bool sat_truthtable(Formula* &f);
+// the same search over the gate list of f, pruned by three-valued evaluation
+// of partial valuations
+bool sat_truthtable_pruned(Formula* &f);
+// the same search over the gate list of f, many valuations per pass
+bool sat_truthtable_bitsliced(Formula* &f);
+// the same search in Gray-code order, re-evaluating only what a flip changes
+bool sat_truthtable_graycode(Formula* &f);
+// the bit-sliced search over the And-Inverter Graph of f
+bool sat_truthtable_aig(Formula* &f);
 
 #endif
\ No newline at end of file